@@ -30,6 +30,7 @@ public class CurveIK : ModuleRules
 					"InputCore",
 					"AnimationCore",
 					"AnimGraphRuntime",
+					"CurveIKSolver",
 			}
 			);
 			
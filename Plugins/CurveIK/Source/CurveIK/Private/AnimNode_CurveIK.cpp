@@ -1,8 +1,37 @@
 #include "AnimNode_CurveIK.h"
+#include "CurveIKBudgetSubsystem.h"
+#include "CurveIKChainCache.h"
+#include "CurveIKCustomVersion.h"
+#include "CurveIKHeightCurve.h"
+#include "CurveIKStats.h"
+#include "CurveIKTrace.h"
 #include "AnimationRuntime.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Animation/AnimInstanceProxy.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "PhysicsEngine/PhysicsAsset.h"
+#include "PhysicsEngine/SkeletalBodySetup.h"
 
+DECLARE_CYCLE_STAT(TEXT("Async Solve"), STAT_CurveIK_AsyncSolve, STATGROUP_CurveIK);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Over Budget Solves"), STAT_CurveIK_OverBudget, STATGROUP_CurveIK);
+
+/** A solve running on a task graph thread. Shared with the task, so it outlives the node if it has to. */
+struct FCurveIKAsyncSolve
+{
+	/** Signalled when the task has written Chain, Result and DebugData */
+	FGraphEventRef CompletionEvent;
+
+	TArray<FCurveIKChainLink> Chain;
+	FTransform RootTransform;
+	FVector TargetLocation;
+	FCurveIKSolveResult Result;
+	FCurveIKDebugData DebugData;
+	bool bCapturedDebugData = false;
+
+	/** Shared with the node until the task ends, so colliders that did not move are not copied */
+	TSharedPtr<const FCurveIKColliders, ESPMode::ThreadSafe> Colliders;
+	uint32 SolveCycles = 0;
+};
 
 FAnimNode_CurveIK::FAnimNode_CurveIK()
 	: EffectorLocation(FVector::ZeroVector)
@@ -13,13 +42,167 @@ FAnimNode_CurveIK::FAnimNode_CurveIK()
 	EffectorLocationSpace = EBoneControlSpace::BCS_WorldSpace;
 	MaxIterations = 100;
 	CurveDetail = 20;
+	MaxCurveError = 0;
 	CurveFitTolerance = 0.01;
 	Stretch = 0;
+	bUseSharedCurveCache = false;
+	bPrecomputeHandleHeights = false;
+	bAsyncSolve = false;
+	AsyncMaxEffectorDrift = 10.f;
+	bAvoidCollisions = false;
+	CollisionRadius = 0;
+	bUsePhysicsAssetColliders = false;
+	Significance = 1.f;
+	OverBudgetPolicy = ECurveIKOverBudgetPolicy::CheaperSettings;
+	OverBudgetMaxIterations = 10;
+	OverBudgetCurveDetail = 8;
+}
+
+bool FAnimNode_CurveIK::Serialize(FArchive& Ar)
+{
+	Ar.UsingCustomVersion(FCurveIKCustomVersion::GUID);
+	return false;
+}
+
+void FAnimNode_CurveIK::PostSerialize(const FArchive& Ar)
+{
+	// Only packages record the version, so duplicates and undo are left alone
+	if (Ar.IsLoading() && Ar.IsPersistent() && !Ar.IsTransacting() && !Ar.HasAnyPortFlags(PPF_Duplicate | PPF_DuplicateForPIE)
+		&& Ar.CustomVer(FCurveIKCustomVersion::GUID) < FCurveIKCustomVersion::EffectorLocationSpace)
+	{
+		EffectorLocationSpace = BCS_ComponentSpace;
+	}
+}
+
+void FCurveIKSolvedChain::Reset()
+{
+	Positions.Reset();
+	CurvePoints.Reset();
+}
+
+void FCurveIKSolvedChain::Capture(const TArray<FCurveIKChainLink>& Chain, const FTransform& InRootTransform, const FVector& Effector)
+{
+	Positions.SetNumUninitialized(Chain.Num());
+	CurvePoints.SetNumUninitialized(Chain.Num());
+	for (int32 LinkIndex = 0; LinkIndex < Chain.Num(); LinkIndex++)
+	{
+		Positions[LinkIndex] = Chain[LinkIndex].Position;
+		CurvePoints[LinkIndex] = Chain[LinkIndex].CurvePoint;
+	}
+	RootTransform = InRootTransform;
+	RootSpaceEffector = InRootTransform.InverseTransformPosition(Effector);
+}
+
+bool FCurveIKSolvedChain::Apply(TArray<FCurveIKChainLink>& InOutChain, const FTransform& InRootTransform) const
+{
+	if (Positions.Num() != InOutChain.Num())
+	{
+		return false;
+	}
+
+	// Points go through the old root's space into the new one, directions only turn with the root
+	for (int32 LinkIndex = 0; LinkIndex < InOutChain.Num(); LinkIndex++)
+	{
+		FCurveIKChainLink& Link = InOutChain[LinkIndex];
+		Link.Position = InRootTransform.TransformPosition(RootTransform.InverseTransformPosition(Positions[LinkIndex]));
+		Link.CurvePoint = CurvePoints[LinkIndex];
+		Link.CurvePoint.Point = InRootTransform.TransformPosition(RootTransform.InverseTransformPosition(Link.CurvePoint.Point));
+		Link.CurvePoint.Tangent = InRootTransform.TransformVectorNoScale(RootTransform.InverseTransformVectorNoScale(Link.CurvePoint.Tangent));
+		Link.CurvePoint.Normal = InRootTransform.TransformVectorNoScale(RootTransform.InverseTransformVectorNoScale(Link.CurvePoint.Normal));
+	}
+	return true;
+}
+
+float FCurveIKSolvedChain::GetEffectorDrift(const FTransform& InRootTransform, const FVector& Effector) const
+{
+	return FVector::Dist(InRootTransform.TransformPosition(RootSpaceEffector), Effector);
+}
+
+bool FAnimNode_CurveIK::CollectAsyncSolve(FCurveIKDebugData* DebugData)
+{
+	if (!AsyncSolve.IsValid() || !AsyncSolve->CompletionEvent.IsValid())
+	{
+		return LastSolve.IsValid();
+	}
+
+	// Waiting could stall this worker behind a busy task graph, so the last result stands in until the task is done
+	if (!AsyncSolve->CompletionEvent->IsComplete())
+	{
+		return LastSolve.IsValid();
+	}
+
+	AsyncSolve->CompletionEvent.SafeRelease();
+	LastSolve.Capture(AsyncSolve->Chain, AsyncSolve->RootTransform, AsyncSolve->TargetLocation);
+	LastSolveResult = AsyncSolve->Result;
+	UpdateEstimatedSolveCycles(AsyncSolve->SolveCycles);
+	if (DebugData && AsyncSolve->bCapturedDebugData)
+	{
+		*DebugData = AsyncSolve->DebugData;
+	}
+
+#if WITH_EDITORONLY_DATA && !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	if (DebugChannel.bObserved)
+	{
+		DebugChannel.AddSolve(FPlatformTime::ToMilliseconds(AsyncSolve->SolveCycles), LastSolveResult);
+	}
+#endif
+
+	return true;
 }
 
-FVector FAnimNode_CurveIK::GetCurrentLocation(FCSPose<FCompactPose>& MeshBases, const FCompactPoseBoneIndex& BoneIndex)
+bool FAnimNode_CurveIK::IsAsyncSolveInFlight() const
 {
-	return MeshBases.GetComponentSpaceTransform(BoneIndex).GetLocation();
+	return AsyncSolve.IsValid() && AsyncSolve->CompletionEvent.IsValid();
+}
+
+void FAnimNode_CurveIK::KickAsyncSolve(const TArray<FCurveIKChainLink>& Chain, const FTransform& RootTransform, const FVector& TargetLocation,
+                                       float MaximumReach, const TSharedPtr<const FCurveIKColliders, ESPMode::ThreadSafe>& InColliders,
+                                       bool bCaptureDebugData, int32 TraceStreamId)
+{
+	if (!AsyncSolve.IsValid())
+	{
+		AsyncSolve = MakeShared<FCurveIKAsyncSolve, ESPMode::ThreadSafe>();
+	}
+
+	TSharedRef<FCurveIKAsyncSolve, ESPMode::ThreadSafe> Solve = AsyncSolve.ToSharedRef();
+	checkSlow(!Solve->CompletionEvent.IsValid());
+	Solve->Chain = Chain;
+	Solve->RootTransform = RootTransform;
+	Solve->TargetLocation = TargetLocation;
+	Solve->bCapturedDebugData = bCaptureDebugData;
+	Solve->Colliders = InColliders;
+
+	// Settings are copied, so the node can be edited while the task runs
+	Solve->CompletionEvent = FFunctionGraphTask::CreateAndDispatchWhenReady(
+		[Solve, TargetLocation, MaximumReach, ControlPointWeight = ControlPointWeight, MaxIterations = MaxIterations,
+		 CurveFitTolerance = CurveFitTolerance, CurveDetail = CurveDetail, Stretch = Stretch, HandleAngle = HandleAngle,
+		 SolverCurveType = ToSolverCurveType(CurveType), MaxCurveError = MaxCurveError, bUseSharedCurveCache = bUseSharedCurveCache,
+		 CollisionRadius = CollisionRadius, TraceStreamId, TraceSettings = GetTraceSettings(),
+		 HeightCurve = bPrecomputeHandleHeights ? HeightCurve : nullptr]()
+		{
+			const uint32 SolveStartCycles = FPlatformTime::Cycles();
+			Solve->Result = CurveIK_AnimationCore::SolveCurveIK(
+				Solve->Chain, TargetLocation, ControlPointWeight, MaximumReach, MaxIterations, CurveFitTolerance, CurveDetail, Stretch,
+				Solve->bCapturedDebugData ? &Solve->DebugData : nullptr, HandleAngle, SolverCurveType, MaxCurveError, bUseSharedCurveCache,
+				Solve->Colliders.Get(), CollisionRadius, HeightCurve.Get());
+			Solve->SolveCycles = FPlatformTime::Cycles() - SolveStartCycles;
+
+			// Hand the colliders back, so the node can move them in place next frame
+			const bool bAvoidedCollisions = Solve->Colliders.IsValid();
+			Solve->Colliders.Reset();
+
+			if (TraceStreamId != INDEX_NONE)
+			{
+				const bool bReproducible = !bAvoidedCollisions && !bUseSharedCurveCache && !HeightCurve.IsValid();
+				FCurveIKTraceWriter::Get().RecordSolve(TraceStreamId, TraceSettings, Solve->Chain, TargetLocation, bReproducible ? &Solve->Result : nullptr);
+			}
+		},
+		GET_STATID(STAT_CurveIK_AsyncSolve), nullptr, ENamedThreads::AnyHiPriThreadNormalTask);
+}
+
+void FAnimNode_CurveIK::UpdateEstimatedSolveCycles(uint32 SolveCycles)
+{
+	EstimatedSolveCycles = EstimatedSolveCycles > 0 ? uint32((uint64(EstimatedSolveCycles) * 7 + SolveCycles) / 8) : SolveCycles;
 }
 
 FTransform FAnimNode_CurveIK::GetTargetTransform(const FTransform& InComponentTransform, FCSPose<FCompactPose>& MeshBases, FBoneSocketTarget& InTarget, EBoneControlSpace Space, const FTransform& InOffset)
@@ -43,9 +226,22 @@ FTransform FAnimNode_CurveIK::GetTargetTransform(const FTransform& InComponentTr
 void FAnimNode_CurveIK::EvaluateSkeletalControl_AnyThread(FComponentSpacePoseContext& Output, TArray<FBoneTransform>& OutBoneTransforms)
 {
 	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(EvaluateSkeletalControl_AnyThread)
-	const FBoneContainer& BoneContainer = Output.Pose.GetPose().GetBoneContainer();
+	EvaluateComponentSpace(Output.AnimInstanceProxy->GetComponentTransform(), Output.Pose, OutBoneTransforms);
+}
 
-	FVector const CSEffectorLocation = EffectorLocation;
+void FAnimNode_CurveIK::EvaluateComponentSpace(const FTransform& ComponentTransform, FCSPose<FCompactPose>& Pose, TArray<FBoneTransform>& OutBoneTransforms)
+{
+	EvaluateChain(ComponentTransform, Pose, false, OutBoneTransforms);
+}
+
+void FAnimNode_CurveIK::EvaluateChain(const FTransform& ComponentTransform, FCSPose<FCompactPose>& Pose, bool bChainFromLocalPose,
+                                      TArray<FBoneTransform>& OutBoneTransforms)
+{
+	const FBoneContainer& BoneContainer = Pose.GetPose().GetBoneContainer();
+
+	// Resolved here on the worker, so bone and socket effectors need no Blueprint logic to follow their target
+	FTransform const CSEffectorTransform = GetTargetTransform(ComponentTransform, Pose, EffectorTarget, EffectorLocationSpace, FTransform(EffectorLocation));
+	FVector const CSEffectorLocation = CSEffectorTransform.GetLocation();
 
 	// Gather all bone indices between root and tip.
 	TArray<FCompactPoseBoneIndex> CompactPoseBoneIndices;
@@ -61,6 +257,12 @@ void FAnimNode_CurveIK::EvaluateSkeletalControl_AnyThread(FComponentSpacePoseCon
 		CompactPoseBoneIndices.Add(BoneData.Bone.GetCompactPoseIndex(BoneContainer));
 	}
 
+	// Offline callers such as baking do not check IsValidToEvaluate, so the chain may not have a single bone
+	if (CompactPoseBoneIndices.Num() == 0)
+	{
+		return;
+	}
+
 	// Maximum length of skeleton segment at full extension
 	float MaximumReach = 0;
 
@@ -73,20 +275,19 @@ void FAnimNode_CurveIK::EvaluateSkeletalControl_AnyThread(FComponentSpacePoseCon
 	CurrentChain.Reserve(NumTransforms);
 
 	// Start with Root Bone
-	{
-		const FCompactPoseBoneIndex& RootBoneIndex = CompactPoseBoneIndices[0];
-		const FTransform& BoneCSTransform = Output.Pose.GetComponentSpaceTransform(RootBoneIndex);
-
-		OutBoneTransforms[0] = FBoneTransform(RootBoneIndex, BoneCSTransform);
-		CurrentChain.Add(FCurveIKChainLink(BoneCSTransform.GetLocation(), 0.f, RootBoneIndex, 0));
-	}
+	const FTransform RootCSTransform = Pose.GetComponentSpaceTransform(CompactPoseBoneIndices[0]);
+	OutBoneTransforms[0] = FBoneTransform(CompactPoseBoneIndices[0], RootCSTransform);
+	CurrentChain.Add(FCurveIKChainLink(RootCSTransform.GetLocation(), 0.f, CompactPoseBoneIndices[0].GetInt(), 0));
 
-	// Go through remaining transforms
+	// Go through remaining transforms. Each is the child of the one before, so their component space transforms can be
+	// built up from the local pose without resolving them in Pose.
 	for (int32 TransformIndex = 1; TransformIndex < NumTransforms; TransformIndex++)
 	{
 		const FCompactPoseBoneIndex& BoneIndex = CompactPoseBoneIndices[TransformIndex];
 
-		const FTransform& BoneCSTransform = Output.Pose.GetComponentSpaceTransform(BoneIndex);
+		const FTransform BoneCSTransform = bChainFromLocalPose
+			? Pose.GetPose()[BoneIndex] * OutBoneTransforms[TransformIndex - 1].Transform
+			: Pose.GetComponentSpaceTransform(BoneIndex);
 		FVector const BoneCSPosition = BoneCSTransform.GetLocation();
 
 		OutBoneTransforms[TransformIndex] = FBoneTransform(BoneIndex, BoneCSTransform);
@@ -96,7 +297,7 @@ void FAnimNode_CurveIK::EvaluateSkeletalControl_AnyThread(FComponentSpacePoseCon
 
 		if (!FMath::IsNearlyZero(BoneLength))
 		{
-			CurrentChain.Add(FCurveIKChainLink(BoneCSPosition, BoneLength, BoneIndex, TransformIndex));
+			CurrentChain.Add(FCurveIKChainLink(BoneCSPosition, BoneLength, BoneIndex.GetInt(), TransformIndex));
 			MaximumReach += BoneLength;
 		}
 		else
@@ -110,78 +311,222 @@ void FAnimNode_CurveIK::EvaluateSkeletalControl_AnyThread(FComponentSpacePoseCon
 
 	int32 const NumChainLinks = CurrentChain.Num();
 
-	const bool bBoneLocationUpdated = CurveIK_AnimationCore::SolveCurveIK(
-		CurrentChain, CSEffectorLocation, ControlPointWeight,
-		MaximumReach, MaxIterations, CurveFitTolerance, CurveDetail, Stretch, CurveIKDebugData, HandleAngle, CurveType);
+	// Directions between links before solving, so the rotation pass does not have to read the pose again
+	TArray<FVector, TInlineAllocator<32>> OldLinkDirs;
+	OldLinkDirs.SetNumUninitialized(FMath::Max(NumChainLinks - 1, 0));
+	for (int32 LinkIndex = 0; LinkIndex < NumChainLinks - 1; LinkIndex++)
+	{
+		OldLinkDirs[LinkIndex] = (CurrentChain[LinkIndex + 1].Position - CurrentChain[LinkIndex].Position).GetUnsafeNormal();
+	}
+
+	// Only pay for debug capture while an editor tool is drawing it
+#if WITH_EDITORONLY_DATA && !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	const bool bDebugObserved = DebugChannel.bObserved;
+	const bool bCaptureDebugData = bDebugObserved && bEnableDebugDraw;
+	FCurveIKDebugData* DebugData = bCaptureDebugData ? &CurveIKDebugData : nullptr;
+#else
+	FCurveIKDebugData* DebugData = nullptr;
+#endif
+
+	if (bActiveCollidersDirty)
+	{
+		UpdateActiveColliders(BoneContainer);
+	}
+
+	const FCurveIKColliders* SolveCollidersToAvoid = nullptr;
+	if (bAvoidCollisions && ActiveColliders.Num() > 0)
+	{
+		UpdateSolveColliders(Pose);
+		SolveCollidersToAvoid = SolveColliders.Get();
+	}
+
+	if (bPrecomputeHandleHeights)
+	{
+		UpdateHeightCurve(MaximumReach);
+	}
+	const FCurveIKHeightCurve* SolveHeightCurve = bPrecomputeHandleHeights ? HeightCurve.Get() : nullptr;
+
+	// Solver inputs are only captured while a trace is being recorded
+	const int32 TraceStreamId = FCurveIKTraceWriter::Get().AcquireStream(TraceStream);
+
+	// Less significant nodes give way first once the world's CurveIK budget for this frame runs low. The reservation
+	// covers this frame's solve, in place or kicked off async.
+	UCurveIKBudgetSubsystem* Budget = BudgetSubsystem.Get();
+	const uint32 ReservedSolveCycles = EstimatedSolveCycles > 0 ? EstimatedSolveCycles : UCurveIKBudgetSubsystem::GetUnmeasuredSolveCycles();
+	const bool bOverBudget = Budget && !Budget->TryReserve(Significance, ReservedSolveCycles);
+	if (bOverBudget)
+	{
+		INC_DWORD_STAT(STAT_CurveIK_OverBudget);
+		CSV_CUSTOM_STAT(CurveIK, OverBudget, 1, ECsvCustomStatOp::Accumulate);
+	}
+
+	if (bAsyncSolve != bAsyncSolveWasEnabled)
+	{
+		AsyncSolve.Reset();
+		LastSolve.Reset();
+		bAsyncSolveWasEnabled = bAsyncSolve;
+	}
 
-	// If we moved some bones, update bone transforms.
-	if (bBoneLocationUpdated)
+	// The last solve is carried along with the root when over budget, and for async nodes unless the effector moved too far
+	// from the one it was solved for. Async nodes keep applying it while their task is still running. Frames without one
+	// solve in place and kick nothing, so a chain is never solved twice.
+	const bool bHasLastSolve = bAsyncSolve ? CollectAsyncSolve(DebugData) : LastSolve.IsValid();
+	const bool bMayReuseLastSolve = (bOverBudget && OverBudgetPolicy == ECurveIKOverBudgetPolicy::ReuseLastResult)
+		|| (bAsyncSolve && LastSolve.GetEffectorDrift(RootCSTransform, CSEffectorLocation) <= AsyncMaxEffectorDrift);
+	const bool bSolvedInPlace = !(bHasLastSolve && bMayReuseLastSolve && LastSolve.Apply(CurrentChain, RootCSTransform));
+	if (bSolvedInPlace)
 	{
-		// First step: update bone transform positions from chain links.
-		for (int32 LinkIndex = 0; LinkIndex < NumChainLinks; LinkIndex++)
+		// A task still running was solved for an older effector than this solve, so its result must not replace it.
+		// The task keeps its own reference, so it can be let go.
+		if (IsAsyncSolveInFlight())
 		{
-			FCurveIKChainLink const& ChainLink = CurrentChain[LinkIndex];
-			OutBoneTransforms[ChainLink.TransformIndex].Transform.SetTranslation(ChainLink.Position);
+			AsyncSolve.Reset();
+		}
 
-			// If there are any zero length children, update position of those
-			int32 const NumChildren = ChainLink.ChildZeroLengthTransformIndices.Num();
-			for (int32 ChildIndex = 0; ChildIndex < NumChildren; ChildIndex++)
-			{
-				OutBoneTransforms[ChainLink.ChildZeroLengthTransformIndices[ChildIndex]].Transform.SetTranslation(ChainLink.Position);
-			}
+		const int32 SolveMaxIterations = bOverBudget ? FMath::Min(MaxIterations, OverBudgetMaxIterations) : MaxIterations;
+		const int32 SolveCurveDetail = bOverBudget ? FMath::Min(CurveDetail, OverBudgetCurveDetail) : CurveDetail;
+
+		// The height curve was fitted with the full settings, so it does not apply to the cheaper ones
+		const uint32 SolveStartCycles = FPlatformTime::Cycles();
+		LastSolveResult = CurveIK_AnimationCore::SolveCurveIK(
+			CurrentChain, CSEffectorLocation, ControlPointWeight,
+			MaximumReach, SolveMaxIterations, CurveFitTolerance, SolveCurveDetail, Stretch, DebugData, HandleAngle, ToSolverCurveType(CurveType),
+			MaxCurveError, bUseSharedCurveCache, SolveCollidersToAvoid, CollisionRadius, bOverBudget ? nullptr : SolveHeightCurve);
+		const uint32 SolveCycles = FPlatformTime::Cycles() - SolveStartCycles;
+
+		if (Budget)
+		{
+			Budget->AddSolveCycles(SolveCycles, bOverBudget ? 0 : ReservedSolveCycles);
+		}
+		if (!bOverBudget)
+		{
+			UpdateEstimatedSolveCycles(SolveCycles);
 		}
 
-		for (int32 LinkIndex = 0; LinkIndex < NumChainLinks - 1; LinkIndex++)
+		if (bAsyncSolve || (Budget && OverBudgetPolicy == ECurveIKOverBudgetPolicy::ReuseLastResult))
 		{
-			FCurveIKChainLink & CurrentLink = CurrentChain[LinkIndex];
-			FCurveIKChainLink const& ChildLink = CurrentChain[LinkIndex + 1];
+			LastSolve.Capture(CurrentChain, RootCSTransform, CSEffectorLocation);
+		}
 
-			// Calculate pre-translation vector between this bone and child
-			FVector const OldDir = (GetCurrentLocation(Output.Pose, FCompactPoseBoneIndex(ChildLink.BoneIndex)) - GetCurrentLocation(Output.Pose, FCompactPoseBoneIndex(CurrentLink.BoneIndex))).GetUnsafeNormal();
+		if (TraceStreamId != INDEX_NONE)
+		{
+			const bool bReproducible = !SolveCollidersToAvoid && !bUseSharedCurveCache && !SolveHeightCurve && !bOverBudget;
+			FCurveIKTraceWriter::Get().RecordSolve(TraceStreamId, GetTraceSettings(), CurrentChain, CSEffectorLocation, bReproducible ? &LastSolveResult : nullptr);
+		}
 
-			// Get vector from the post-translation bone to it's child
-			FVector const NewDir = (ChildLink.Position - CurrentLink.Position).GetUnsafeNormal();
+#if WITH_EDITORONLY_DATA && !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+		if (bDebugObserved)
+		{
+			DebugChannel.AddSolve(FPlatformTime::ToMilliseconds(SolveCycles), LastSolveResult);
+		}
+#endif
+	}
 
-			// Calculate axis of rotation from pre-translation vector to post-translation vector
-			FVector const RotationAxis = FVector::CrossProduct(OldDir, NewDir).GetSafeNormal();
-			float const RotationAngle = FMath::Acos(FVector::DotProduct(OldDir, NewDir));
-			FQuat const DeltaRotation = FQuat(RotationAxis, RotationAngle);
-			// We're going to multiply it, in order to not have to re-normalize the final quaternion, it has to be a unit quaternion.
-			checkSlow(DeltaRotation.IsNormalized());
+	// Over budget async nodes keep applying their last result until there is budget to kick a new solve, which is charged
+	// by the reservation above. Only one solve is kept in flight.
+	if (bAsyncSolve && !bOverBudget && !bSolvedInPlace)
+	{
+		if (!IsAsyncSolveInFlight())
+		{
+			KickAsyncSolve(CurrentChain, RootCSTransform, CSEffectorLocation, MaximumReach, SolveCollidersToAvoid ? SolveColliders : nullptr,
+			               DebugData != nullptr, TraceStreamId);
+		}
+		else if (Budget)
+		{
+			// Nothing was solved or kicked this frame, so the reservation is handed back
+			Budget->AddSolveCycles(0, ReservedSolveCycles);
+		}
+	}
 
-			// Calculate absolute rotation and set it
-			FTransform& CurrentBoneTransform = OutBoneTransforms[CurrentLink.TransformIndex].Transform;		
-			CurrentBoneTransform.SetRotation(DeltaRotation * CurrentBoneTransform.GetRotation());
-			CurrentBoneTransform.NormalizeRotation();
+	// Update bone transform positions from chain links.
+	for (int32 LinkIndex = 0; LinkIndex < NumChainLinks; LinkIndex++)
+	{
+		FCurveIKChainLink const& ChainLink = CurrentChain[LinkIndex];
+		OutBoneTransforms[ChainLink.TransformIndex].Transform.SetTranslation(ChainLink.Position);
 
-			// Correct the bone roll
-			{
-				FVector OldBoneRollDir = CurrentBoneTransform.GetRotation().GetUpVector() * -1.f;
-
-				FVector NewBoneRollDir = FVector::VectorPlaneProject(CurrentLink.CurvePoint.Normal, NewDir);
-				FQuat const DeltaBoneRoll = FQuat::FindBetweenVectors(OldBoneRollDir, NewBoneRollDir);
-				
-				CurrentBoneTransform.SetRotation(DeltaBoneRoll * CurrentBoneTransform.GetRotation());
-				CurrentBoneTransform.NormalizeRotation();
-				CurrentLink.BoneDownVector = CurrentBoneTransform.GetRotation().GetUpVector() * -1.f;
-			}
+		// If there are any zero length children, update position of those
+		int32 const NumChildren = ChainLink.ChildZeroLengthTransformIndices.Num();
+		for (int32 ChildIndex = 0; ChildIndex < NumChildren; ChildIndex++)
+		{
+			OutBoneTransforms[ChainLink.ChildZeroLengthTransformIndices[ChildIndex]].Transform.SetTranslation(ChainLink.Position);
+		}
+	}
 
-			// Update zero length children if any
-			int32 const NumChildren = CurrentLink.ChildZeroLengthTransformIndices.Num();
-			for (int32 ChildIndex = 0; ChildIndex < NumChildren; ChildIndex++)
-			{
-				FTransform& ChildBoneTransform = OutBoneTransforms[CurrentLink.ChildZeroLengthTransformIndices[ChildIndex]].Transform;
-				ChildBoneTransform.SetRotation(DeltaRotation * ChildBoneTransform.GetRotation());
-				ChildBoneTransform.NormalizeRotation();
+	SCOPE_CYCLE_COUNTER(STAT_CurveIK_Rotation);
+	CSV_SCOPED_TIMING_STAT(CurveIK, Rotation);
+
+	for (int32 LinkIndex = 0; LinkIndex < NumChainLinks - 1; LinkIndex++)
+	{
+		FCurveIKChainLink & CurrentLink = CurrentChain[LinkIndex];
+		FCurveIKChainLink const& ChildLink = CurrentChain[LinkIndex + 1];
+
+		// Pre-translation vector between this bone and child
+		FVector const OldDir = OldLinkDirs[LinkIndex];
+
+		// Get vector from the post-translation bone to it's child
+		FVector const NewDir = (ChildLink.Position - CurrentLink.Position).GetUnsafeNormal();
+
+		// Turn the bone towards its child and roll it to follow the curve
+		FTransform& CurrentBoneTransform = OutBoneTransforms[CurrentLink.TransformIndex].Transform;
+		FQuat DeltaRotation;
+		CurrentBoneTransform.SetRotation(CurveIK_AnimationCore::OrientLinkBone(CurrentBoneTransform.GetRotation(), OldDir, NewDir,
+		                                                                       CurrentLink.CurvePoint.Normal, DeltaRotation));
+		CurrentLink.BoneDownVector = CurrentBoneTransform.GetRotation().GetUpVector() * -1.f;
+
+		// Update zero length children if any
+		int32 const NumChildren = CurrentLink.ChildZeroLengthTransformIndices.Num();
+		for (int32 ChildIndex = 0; ChildIndex < NumChildren; ChildIndex++)
+		{
+			FTransform& ChildBoneTransform = OutBoneTransforms[CurrentLink.ChildZeroLengthTransformIndices[ChildIndex]].Transform;
+			ChildBoneTransform.SetRotation(DeltaRotation * ChildBoneTransform.GetRotation());
+			ChildBoneTransform.NormalizeRotation();
 
-			}
 		}
-#if WITH_EDITOR
-		Chain = CurrentChain;
-#endif // WITH_EDITOR
+	}
+#if WITH_EDITORONLY_DATA && !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	if (bCaptureDebugData)
+	{
+		DebugChannel.Publish(CurveIKDebugData, CurrentChain);
+	}
+#endif
+}
+
+void FAnimNode_CurveIK::EvaluateLocalSpace(const FTransform& ComponentTransform, FCSPose<FCompactPose>& Pose, TArray<FBoneTransform>& OutBoneTransforms)
+{
+	EvaluateChain(ComponentTransform, Pose, true, OutBoneTransforms);
+	if (OutBoneTransforms.Num() == 0)
+	{
+		return;
+	}
+
+	// Every bone of the chain is the parent of the next, so walk back from the tip while the parents are still in component space
+	for (int32 TransformIndex = OutBoneTransforms.Num() - 1; TransformIndex > 0; TransformIndex--)
+	{
+		const FBoneTransform& ParentTransform = OutBoneTransforms[TransformIndex - 1];
+		checkSlow(Pose.GetPose().GetParentBoneIndex(OutBoneTransforms[TransformIndex].BoneIndex) == ParentTransform.BoneIndex);
+		OutBoneTransforms[TransformIndex].Transform = OutBoneTransforms[TransformIndex].Transform.GetRelativeTransform(ParentTransform.Transform);
+	}
 
+	// The root's parent was already resolved to component space to place the root, so this does not resolve anything new
+	FBoneTransform& RootTransform = OutBoneTransforms[0];
+	const FCompactPoseBoneIndex RootParentIndex = Pose.GetPose().GetParentBoneIndex(RootTransform.BoneIndex);
+	if (RootParentIndex != INDEX_NONE)
+	{
+		RootTransform.Transform = RootTransform.Transform.GetRelativeTransform(Pose.GetComponentSpaceTransform(RootParentIndex));
+	}
+
+	// Pose still holds the input local transforms, as the solved ones were never set on it
+	const float BlendAlpha = FMath::Clamp(Alpha, 0.f, 1.f);
+	if (FAnimWeight::IsFullWeight(BlendAlpha))
+	{
+		return;
 	}
 
+	for (FBoneTransform& BoneTransform : OutBoneTransforms)
+	{
+		const FTransform SolvedTransform = BoneTransform.Transform;
+		BoneTransform.Transform.Blend(Pose.GetPose()[BoneTransform.BoneIndex], SolvedTransform, BlendAlpha);
+	}
 }
 
 bool FAnimNode_CurveIK::IsValidToEvaluate(const USkeleton* Skeleton, const FBoneContainer& RequiredBones)
@@ -192,6 +537,7 @@ bool FAnimNode_CurveIK::IsValidToEvaluate(const USkeleton* Skeleton, const FBone
 			TipBone.IsValidToEvaluate(RequiredBones)
 			&& RootBone.IsValidToEvaluate(RequiredBones)
 			&& RequiredBones.BoneIsChildOf(TipBone.BoneIndex, RootBone.BoneIndex)
+			&& (EffectorLocationSpace == BCS_WorldSpace || EffectorLocationSpace == BCS_ComponentSpace || EffectorTarget.IsValidToEvaluate(RequiredBones))
 			);
 }
 
@@ -206,69 +552,104 @@ void FAnimNode_CurveIK::InitializeBoneReferences(const FBoneContainer& RequiredB
 	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(InitializeBoneReferences)
 	TipBone.Initialize(RequiredBones);
 	RootBone.Initialize(RequiredBones);
+	EffectorTarget.InitializeBoneReferences(RequiredBones);
+
+	GatherBoneReferences(RequiredBones);
+
+	if (bPrecomputeHandleHeights)
+	{
+		// Zero length bones add nothing, so this matches the reach measured when the whole chain evaluates
+		float MaximumReach = 0.f;
+		for (const float BoneLength : CachedBoneLengths)
+		{
+			MaximumReach += BoneLength;
+		}
+		UpdateHeightCurve(MaximumReach);
+	}
 
-	GatherBoneReferences(RequiredBones.GetReferenceSkeleton());
+	UpdateActiveColliders(RequiredBones);
 
 	for (FCurveIK_CachedBoneData& CachedBoneData : CachedBoneReferences)
 	{
 		CachedBoneData.Bone.Initialize(RequiredBones);
 	}
+
+	// Results solved for the previous bones would be applied to the wrong links
+	AsyncSolve.Reset();
+	LastSolve.Reset();
 }
 
-void FAnimNode_CurveIK::GatherBoneReferences(const FReferenceSkeleton& RefSkeleton)
+void FAnimNode_CurveIK::UpdateActiveColliders(const FBoneContainer& RequiredBones)
 {
-	CachedBoneReferences.Reset();
-
-	int32 RootIndex = RefSkeleton.FindBoneIndex(RootBone.BoneName);
-	int32 TipIndex = RefSkeleton.FindBoneIndex(TipBone.BoneName);
-
-	// Loop backwards from tip to root inserting on the lefts side of the array
-	int32 BoneIndex = TipIndex;
-	do
+	ActiveColliders.Reset();
+	ActiveColliders.Append(Colliders);
+	for (const FCurveIKCollider& Collider : PhysicsAssetColliders)
 	{
-		FName BoneName = RefSkeleton.GetBoneName(BoneIndex);
-		CachedBoneReferences.EmplaceAt(0, BoneName, BoneIndex);
-		BoneIndex = RefSkeleton.GetParentIndex(BoneIndex);
-	} while (BoneIndex != RootIndex);
-
-	FName BoneName = RefSkeleton.GetBoneName(BoneIndex);
-	CachedBoneReferences.EmplaceAt(0, BoneName, BoneIndex);
+		// Bodies of the chain itself would always be penetrated
+		const bool bIsChainBone = CachedBoneReferences.ContainsByPredicate([&Collider](const FCurveIK_CachedBoneData& BoneData)
+		{
+			return BoneData.Bone.BoneName == Collider.Bone.BoneName;
+		});
+		if (!bIsChainBone)
+		{
+			ActiveColliders.Add(Collider);
+		}
+	}
+	for (FCurveIKCollider& Collider : ActiveColliders)
+	{
+		Collider.Bone.Initialize(RequiredBones);
+	}
 
-	GatherBoneLengths(RefSkeleton);
+	bActiveCollidersDirty = false;
+	bSolveCollidersDirty = true;
 }
 
-void FAnimNode_CurveIK::GatherBoneLengths(const FReferenceSkeleton& RefSkeleton)
+void FAnimNode_CurveIK::SetColliders(const TArray<FCurveIKCollider>& InColliders, bool bInUsePhysicsAssetColliders)
 {
-	if (CachedBoneReferences.Num() > 0)
+	Colliders = InColliders;
+	if (bUsePhysicsAssetColliders != bInUsePhysicsAssetColliders)
 	{
-		TArray<FTransform> ComponentSpaceTransforms;
-		FAnimationRuntime::FillUpComponentSpaceTransforms(RefSkeleton, RefSkeleton.GetRefBonePose(), ComponentSpaceTransforms);
-
-		// Build cached bone info
-		CachedBoneLengths.Reset();
-		for (int32 BoneIndex = 0; BoneIndex < CachedBoneReferences.Num(); BoneIndex++)
+		bUsePhysicsAssetColliders = bInUsePhysicsAssetColliders;
+		PhysicsAssetColliders.Reset();
+		if (bUsePhysicsAssetColliders)
 		{
-			float BoneLength = 0.0f;
+			GatherPhysicsAssetColliders(PhysicsAsset.Get());
+		}
+	}
+	bActiveCollidersDirty = true;
+}
 
-			if (BoneIndex > 0)
-			{
-				FCurveIK_CachedBoneData& BoneData = CachedBoneReferences[BoneIndex];
-				const FTransform& Transform = ComponentSpaceTransforms[BoneData.RefSkeletonIndex];
+void FAnimNode_CurveIK::GatherBoneReferences(const FBoneContainer& RequiredBones)
+{
+	CachedBoneReferences.Reset();
+	CachedBoneLengths.Reset();
+
+	// Measured once per mesh and chain, then shared by every instance
+	ChainKey.Asset = RequiredBones.GetAsset();
+	ChainKey.RootBone = RootBone.BoneName;
+	ChainKey.TipBone = TipBone.BoneName;
+	const TSharedPtr<const FCurveIKChainMetadata, ESPMode::ThreadSafe> ChainMetadata = FCurveIKChainCache::Get().FindOrAdd(
+		RequiredBones.GetAsset(), RequiredBones.GetReferenceSkeleton(), RootBone.BoneName, TipBone.BoneName);
+	if (!ChainMetadata.IsValid())
+	{
+		return;
+	}
 
-				const FCurveIK_CachedBoneData& ParentBoneData = CachedBoneReferences[BoneIndex - 1];
-				const FTransform& ParentTransform = ComponentSpaceTransforms[ParentBoneData.RefSkeletonIndex];
-				const FVector BoneDir = Transform.GetLocation() - ParentTransform.GetLocation();
-				BoneLength = BoneDir.Size();
-			}
-			CachedBoneLengths.Add(BoneLength);
-		}
+	CachedBoneReferences.Reserve(ChainMetadata->BoneNames.Num());
+	for (int32 ChainIndex = 0; ChainIndex < ChainMetadata->BoneNames.Num(); ChainIndex++)
+	{
+		CachedBoneReferences.Emplace(ChainMetadata->BoneNames[ChainIndex], ChainMetadata->RefSkeletonIndices[ChainIndex]);
 	}
+	CachedBoneLengths = ChainMetadata->BoneLengths;
 }
 
 void FAnimNode_CurveIK::GatherDebugData(FNodeDebugData& DebugData)
 {
 	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(GatherDebugData)
 	FString DebugLine = DebugData.GetNodeName(this);
+	DebugLine += FString::Printf(TEXT("(%s, Converged: %s, Iterations: %d, Residual: %.3f, Tip Error: %.3f)"),
+		LexToString(LastSolveResult.Path), LastSolveResult.bConverged ? TEXT("true") : TEXT("false"),
+		LastSolveResult.Iterations, LastSolveResult.ArcLengthResidual, LastSolveResult.TipError);
 
 	DebugData.AddDebugItem(DebugLine);
 	ComponentPose.GatherDebugData(DebugData);
@@ -278,4 +659,176 @@ void FAnimNode_CurveIK::Initialize_AnyThread(const FAnimationInitializeContext&
 {
 	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(Initialize_AnyThread)
 	Super::Initialize_AnyThread(Context);
-}
\ No newline at end of file
+	EffectorTarget.Initialize(Context.AnimInstanceProxy);
+
+	const USkeletalMeshComponent* SkelMeshComp = Context.AnimInstanceProxy->GetSkelMeshComponent();
+	PhysicsAsset = SkelMeshComp ? SkelMeshComp->GetPhysicsAsset() : nullptr;
+	PhysicsAssetColliders.Reset();
+	if (bUsePhysicsAssetColliders)
+	{
+		GatherPhysicsAssetColliders(PhysicsAsset.Get());
+	}
+
+	// Start over with a solve of this instance's own. Any solve still in flight keeps its state alive until it ends.
+	AsyncSolve.Reset();
+	LastSolve.Reset();
+	SolveColliders.Reset();
+
+	const USkeletalMeshComponent* OwningComponent = Context.AnimInstanceProxy->GetSkelMeshComponent();
+	UWorld* World = OwningComponent ? OwningComponent->GetWorld() : nullptr;
+	BudgetSubsystem = World ? World->GetSubsystem<UCurveIKBudgetSubsystem>() : nullptr;
+	EstimatedSolveCycles = 0;
+}
+
+void FAnimNode_CurveIK::GatherPhysicsAssetColliders(const UPhysicsAsset* InPhysicsAsset)
+{
+	if (!InPhysicsAsset)
+	{
+		return;
+	}
+
+	// Box and convex bodies are skipped, the solver only tests spheres and capsules
+	for (const USkeletalBodySetup* BodySetup : InPhysicsAsset->SkeletalBodySetups)
+	{
+		if (!BodySetup)
+		{
+			continue;
+		}
+
+		for (const FKSphereElem& Sphere : BodySetup->AggGeom.SphereElems)
+		{
+			FCurveIKCollider& Collider = PhysicsAssetColliders.AddDefaulted_GetRef();
+			Collider.Bone = FBoneReference(BodySetup->BoneName);
+			Collider.Start = Sphere.Center;
+			Collider.End = Sphere.Center;
+			Collider.Radius = Sphere.Radius;
+		}
+
+		for (const FKSphylElem& Sphyl : BodySetup->AggGeom.SphylElems)
+		{
+			const FVector HalfAxis = Sphyl.Rotation.RotateVector(FVector(0.f, 0.f, Sphyl.Length * 0.5f));
+			FCurveIKCollider& Collider = PhysicsAssetColliders.AddDefaulted_GetRef();
+			Collider.Bone = FBoneReference(BodySetup->BoneName);
+			Collider.Start = Sphyl.Center - HalfAxis;
+			Collider.End = Sphyl.Center + HalfAxis;
+			Collider.Radius = Sphyl.Radius;
+		}
+	}
+}
+
+void FAnimNode_CurveIK::UpdateSolveColliders(FCSPose<FCompactPose>& MeshBases)
+{
+	const FBoneContainer& BoneContainer = MeshBases.GetPose().GetBoneContainer();
+
+	if (!bSolveCollidersDirty)
+	{
+		// Colliders on bones the animation does not move are left as they are
+		bool bMoved = false;
+		for (int32 Index = 0; Index < SolveColliderSources.Num() && !bMoved; Index++)
+		{
+			const FCurveIKCollider& Collider = ActiveColliders[SolveColliderSources[Index]];
+			const FTransform& BoneTransform = MeshBases.GetComponentSpaceTransform(Collider.Bone.GetCompactPoseIndex(BoneContainer));
+			bMoved = !BoneTransform.Equals(SolveColliderBoneTransforms[Index], KINDA_SMALL_NUMBER);
+		}
+		if (!bMoved)
+		{
+			return;
+		}
+
+		// The async solve in flight still reads the current colliders, so place fresh ones instead of moving them
+		bSolveCollidersDirty = !SolveColliders.IsUnique();
+	}
+
+	if (bSolveCollidersDirty)
+	{
+		SolveColliders = MakeShared<FCurveIKColliders, ESPMode::ThreadSafe>();
+		SolveColliderSources.Reset();
+		SolveColliderBoneTransforms.Reset();
+		for (int32 ColliderIndex = 0; ColliderIndex < ActiveColliders.Num(); ColliderIndex++)
+		{
+			const FCurveIKCollider& Collider = ActiveColliders[ColliderIndex];
+			if (Collider.Bone.IsValidToEvaluate(BoneContainer))
+			{
+				const FTransform& BoneTransform = MeshBases.GetComponentSpaceTransform(Collider.Bone.GetCompactPoseIndex(BoneContainer));
+				SolveColliders->AddCapsule(BoneTransform.TransformPosition(Collider.Start), BoneTransform.TransformPosition(Collider.End), Collider.Radius);
+				SolveColliderSources.Add(ColliderIndex);
+				SolveColliderBoneTransforms.Add(BoneTransform);
+			}
+		}
+		SolveColliders->Build();
+		bSolveCollidersDirty = false;
+		return;
+	}
+
+	for (int32 Index = 0; Index < SolveColliderSources.Num(); Index++)
+	{
+		const FCurveIKCollider& Collider = ActiveColliders[SolveColliderSources[Index]];
+		const FTransform& BoneTransform = MeshBases.GetComponentSpaceTransform(Collider.Bone.GetCompactPoseIndex(BoneContainer));
+		SolveColliders->MoveCapsule(Index, BoneTransform.TransformPosition(Collider.Start), BoneTransform.TransformPosition(Collider.End));
+		SolveColliderBoneTransforms[Index] = BoneTransform;
+	}
+	SolveColliders->Refit();
+}
+
+void FAnimNode_CurveIK::UpdateHeightCurve(float MaximumReach)
+{
+	FCurveIKHeightCurve::FSettings Settings;
+	Settings.MaximumReach = MaximumReach;
+	Settings.ControlPointWeight = ControlPointWeight;
+	Settings.MaxIterations = MaxIterations;
+	Settings.CurveFitTolerance = CurveFitTolerance;
+	Settings.NumPointsOnCurve = CurveDetail;
+	Settings.HandleAngle = HandleAngle;
+	Settings.MaxCurveError = MaxCurveError;
+	Settings.CurveType = ToSolverCurveType(CurveType);
+
+	// Async solves in flight keep the previous curve alive until they finish
+	if (!HeightCurve.IsValid() || HeightCurve->GetSettings() != Settings)
+	{
+		HeightCurve = FCurveIKChainCache::Get().FindOrAddHeightCurve(ChainKey, Settings);
+	}
+}
+
+SIZE_T FAnimNode_CurveIK::GetAllocatedSize() const
+{
+	SIZE_T Size = CachedBoneReferences.GetAllocatedSize() + CachedBoneLengths.GetAllocatedSize()
+		+ Colliders.GetAllocatedSize() + PhysicsAssetColliders.GetAllocatedSize() + ActiveColliders.GetAllocatedSize()
+		+ SolveColliderSources.GetAllocatedSize() + SolveColliderBoneTransforms.GetAllocatedSize()
+		+ LastSolve.GetAllocatedSize();
+
+	if (SolveColliders.IsValid())
+	{
+		Size += sizeof(FCurveIKColliders) + SolveColliders->GetAllocatedSize();
+	}
+
+	if (AsyncSolve.IsValid())
+	{
+		// A solve in flight is still writing its arrays
+		Size += sizeof(FCurveIKAsyncSolve);
+		if (!AsyncSolve->CompletionEvent.IsValid() || AsyncSolve->CompletionEvent->IsComplete())
+		{
+			Size += CurveIK_AnimationCore::GetChainAllocatedSize(AsyncSolve->Chain) + AsyncSolve->DebugData.GetAllocatedSize();
+		}
+	}
+
+#if WITH_EDITORONLY_DATA && !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	Size += CurveIKDebugData.GetAllocatedSize() + DebugChannel.GetAllocatedSize();
+#endif
+
+	return Size;
+}
+
+FCurveIKTraceSettings FAnimNode_CurveIK::GetTraceSettings() const
+{
+	FCurveIKTraceSettings Settings;
+	Settings.ControlPointWeight = ControlPointWeight;
+	Settings.MaxIterations = MaxIterations;
+	Settings.CurveFitTolerance = CurveFitTolerance;
+	Settings.NumPointsOnCurve = CurveDetail;
+	Settings.Stretch = Stretch;
+	Settings.HandleAngle = HandleAngle;
+	Settings.MaxCurveError = MaxCurveError;
+	Settings.CurveType = static_cast<uint8>(ToSolverCurveType(CurveType));
+	Settings.bUseSharedCurveCache = bUseSharedCurveCache;
+	return Settings;
+}
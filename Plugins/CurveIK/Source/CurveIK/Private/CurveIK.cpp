@@ -1,18 +1,42 @@
 // Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
 
 #include "CurveIK.h"
+#include "CurveIKChainCache.h"
+#include "Animation/Skeleton.h"
+#include "Engine/SkeletalMesh.h"
+#include "UObject/UObjectGlobals.h"
 
 #define LOCTEXT_NAMESPACE "FCurveIKModule"
 
 void FCurveIKModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddLambda([]()
+	{
+		FCurveIKChainCache::Get().RemoveStale();
+	});
+
+#if WITH_EDITOR
+	// Reimporting a mesh or editing its skeleton finishes with a property change. Edits to any other object leave the
+	// cache alone.
+	ObjectPropertyChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddLambda([](UObject* Object, FPropertyChangedEvent&)
+	{
+		if (Object && (Object->IsA<USkeletalMesh>() || Object->IsA<USkeleton>()))
+		{
+			FCurveIKChainCache::Get().Remove(Object);
+		}
+	});
+#endif
 }
 
 void FCurveIKModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+#if WITH_EDITOR
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(ObjectPropertyChangedHandle);
+#endif
 }
 
 #undef LOCTEXT_NAMESPACE
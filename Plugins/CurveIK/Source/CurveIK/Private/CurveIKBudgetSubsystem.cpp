@@ -0,0 +1,80 @@
+#include "CurveIKBudgetSubsystem.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+static TAutoConsoleVariable<float> CVarCurveIKBudgetMicroseconds(
+	TEXT("CurveIK.Budget.Microseconds"),
+	0.f,
+	TEXT("Total time in microseconds that the CurveIK nodes of a world may spend solving each frame. 0 disables the budget."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarCurveIKBudgetUnmeasuredSolveMicroseconds(
+	TEXT("CurveIK.Budget.UnmeasuredSolveMicroseconds"),
+	100.f,
+	TEXT("Time in microseconds that a CurveIK node reserves from the budget for its first solve, before it has measured one."),
+	ECVF_Scalability);
+
+float UCurveIKBudgetSubsystem::GetBudgetMicroseconds()
+{
+	return FMath::Max(CVarCurveIKBudgetMicroseconds.GetValueOnAnyThread(), 0.f);
+}
+
+uint32 UCurveIKBudgetSubsystem::GetUnmeasuredSolveCycles()
+{
+	const float Microseconds = FMath::Max(CVarCurveIKBudgetUnmeasuredSolveMicroseconds.GetValueOnAnyThread(), 0.f);
+	return FMath::Max(uint32(Microseconds / (FPlatformTime::GetSecondsPerCycle() * 1000000.0)), 1u);
+}
+
+uint64 UCurveIKBudgetSubsystem::GetUsedCycles(uint64 InFrameUsage, uint64 Frame)
+{
+	return (InFrameUsage >> UsedCyclesBits) == (Frame & (MAX_uint64 >> UsedCyclesBits)) ? InFrameUsage & ((1ull << UsedCyclesBits) - 1) : 0;
+}
+
+uint64 UCurveIKBudgetSubsystem::MakeFrameUsage(uint64 Frame, uint64 UsedCycles)
+{
+	return (Frame << UsedCyclesBits) | FMath::Min(UsedCycles, (1ull << UsedCyclesBits) - 1);
+}
+
+bool UCurveIKBudgetSubsystem::TryReserve(float Significance, uint32 EstimatedCycles)
+{
+	const float BudgetMicroseconds = GetBudgetMicroseconds();
+	if (BudgetMicroseconds <= 0.f)
+	{
+		return true;
+	}
+
+	// The first reservation of a frame starts it from zero in the same exchange, so no charge can fall in between
+	const uint64 Frame = GFrameCounter;
+	const double AllowedMicroseconds = BudgetMicroseconds * FMath::Clamp(Significance, 0.f, 1.f);
+	uint64 State = FrameUsage.Load();
+	uint64 Used;
+	do
+	{
+		Used = GetUsedCycles(State, Frame);
+		if (FPlatformTime::ToMilliseconds64(Used) * 1000.0 >= AllowedMicroseconds)
+		{
+			return false;
+		}
+	}
+	while (!FrameUsage.CompareExchange(State, MakeFrameUsage(Frame, Used + EstimatedCycles)));
+
+	return true;
+}
+
+void UCurveIKBudgetSubsystem::AddSolveCycles(uint32 Cycles, uint32 ReservedCycles)
+{
+	// The frame may have moved on since the reservation, taking it with it
+	const uint64 Frame = GFrameCounter;
+	uint64 State = FrameUsage.Load();
+	uint64 Used;
+	do
+	{
+		Used = GetUsedCycles(State, Frame);
+	}
+	while (!FrameUsage.CompareExchange(State, MakeFrameUsage(Frame, Used + Cycles - FMath::Min<uint64>(ReservedCycles, Used + Cycles))));
+}
+
+float UCurveIKBudgetSubsystem::GetUsedMicroseconds() const
+{
+	return float(FPlatformTime::ToMilliseconds64(GetUsedCycles(FrameUsage.Load(), GFrameCounter)) * 1000.0);
+}
@@ -0,0 +1,247 @@
+#include "CurveIKChainCache.h"
+#include "Algo/Reverse.h"
+#include "Animation/Skeleton.h"
+#include "Engine/SkeletalMesh.h"
+#include "Misc/ScopeLock.h"
+#include "ReferenceSkeleton.h"
+
+bool FCurveIKChainMetadata::Build(const FReferenceSkeleton& RefSkeleton, FName RootBone, FName TipBone, FCurveIKChainMetadata& OutMetadata)
+{
+	OutMetadata.BoneNames.Reset();
+	OutMetadata.RefSkeletonIndices.Reset();
+	OutMetadata.BoneLengths.Reset();
+	OutMetadata.RefPoseHash = 0;
+
+	const int32 RootIndex = RefSkeleton.FindBoneIndex(RootBone);
+	const int32 TipIndex = RefSkeleton.FindBoneIndex(TipBone);
+	if (RootIndex == INDEX_NONE || TipIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	for (int32 BoneIndex = TipIndex; BoneIndex != RootIndex; BoneIndex = RefSkeleton.GetParentIndex(BoneIndex))
+	{
+		if (BoneIndex == INDEX_NONE)
+		{
+			OutMetadata.RefSkeletonIndices.Reset();
+			return false;
+		}
+		OutMetadata.RefSkeletonIndices.Add(BoneIndex);
+	}
+	OutMetadata.RefSkeletonIndices.Add(RootIndex);
+	Algo::Reverse(OutMetadata.RefSkeletonIndices);
+	OutMetadata.RefPoseHash = HashRefPose(RefSkeleton, OutMetadata.RefSkeletonIndices);
+
+	// Component space transform of the root from its ancestors, then of every chain bone from its parent in the chain
+	const TArray<FTransform>& RefBonePose = RefSkeleton.GetRefBonePose();
+	FTransform BoneTransform = RefBonePose[RootIndex];
+	for (int32 ParentIndex = RefSkeleton.GetParentIndex(RootIndex); ParentIndex != INDEX_NONE; ParentIndex = RefSkeleton.GetParentIndex(ParentIndex))
+	{
+		BoneTransform = BoneTransform * RefBonePose[ParentIndex];
+	}
+
+	OutMetadata.BoneNames.Reserve(OutMetadata.RefSkeletonIndices.Num());
+	OutMetadata.BoneLengths.Reserve(OutMetadata.RefSkeletonIndices.Num());
+	for (int32 ChainIndex = 0; ChainIndex < OutMetadata.RefSkeletonIndices.Num(); ChainIndex++)
+	{
+		const int32 RefSkeletonIndex = OutMetadata.RefSkeletonIndices[ChainIndex];
+		OutMetadata.BoneNames.Add(RefSkeleton.GetBoneName(RefSkeletonIndex));
+
+		if (ChainIndex == 0)
+		{
+			OutMetadata.BoneLengths.Add(0.f);
+		}
+		else
+		{
+			const FVector ParentLocation = BoneTransform.GetLocation();
+			BoneTransform = RefBonePose[RefSkeletonIndex] * BoneTransform;
+			OutMetadata.BoneLengths.Add(FVector::Dist(ParentLocation, BoneTransform.GetLocation()));
+		}
+	}
+
+	return true;
+}
+
+uint32 FCurveIKChainMetadata::HashRefPose(const FReferenceSkeleton& RefSkeleton, const TArray<int32>& RefSkeletonIndices)
+{
+	const TArray<FTransform>& RefBonePose = RefSkeleton.GetRefBonePose();
+	auto HashBone = [&RefSkeleton, &RefBonePose](uint32 Hash, int32 BoneIndex)
+	{
+		if (!RefBonePose.IsValidIndex(BoneIndex))
+		{
+			return HashCombine(Hash, GetTypeHash(INDEX_NONE));
+		}
+
+		const FTransform& BoneTransform = RefBonePose[BoneIndex];
+		const FVector Translation = BoneTransform.GetTranslation();
+		const FQuat Rotation = BoneTransform.GetRotation();
+		const FVector Scale = BoneTransform.GetScale3D();
+		Hash = HashCombine(Hash, GetTypeHash(RefSkeleton.GetBoneName(BoneIndex)));
+		Hash = HashCombine(Hash, GetTypeHash(RefSkeleton.GetParentIndex(BoneIndex)));
+		Hash = FCrc::MemCrc32(&Translation, sizeof(Translation), Hash);
+		Hash = FCrc::MemCrc32(&Rotation, sizeof(Rotation), Hash);
+		return FCrc::MemCrc32(&Scale, sizeof(Scale), Hash);
+	};
+
+	uint32 Hash = GetTypeHash(RefSkeleton.GetNum());
+	for (const int32 BoneIndex : RefSkeletonIndices)
+	{
+		Hash = HashBone(Hash, BoneIndex);
+	}
+	if (RefSkeletonIndices.Num() > 0 && RefBonePose.IsValidIndex(RefSkeletonIndices[0]))
+	{
+		for (int32 ParentIndex = RefSkeleton.GetParentIndex(RefSkeletonIndices[0]); ParentIndex != INDEX_NONE; ParentIndex = RefSkeleton.GetParentIndex(ParentIndex))
+		{
+			Hash = HashBone(Hash, ParentIndex);
+		}
+	}
+	return Hash;
+}
+
+FCurveIKChainCache& FCurveIKChainCache::Get()
+{
+	static FCurveIKChainCache Instance;
+	return Instance;
+}
+
+TSharedPtr<const FCurveIKChainMetadata, ESPMode::ThreadSafe> FCurveIKChainCache::FindOrAdd(const UObject* Asset, const FReferenceSkeleton& RefSkeleton,
+                                                                                          FName RootBone, FName TipBone)
+{
+	FKey Key;
+	Key.Asset = Asset;
+	Key.RootBone = RootBone;
+	Key.TipBone = TipBone;
+
+	{
+		// Hits are not checked against RefSkeleton, which would cost about as much as building the chain. Chains of
+		// reimported assets are dropped by Remove and RemoveStale instead.
+		FScopeLock ScopeLock(&Lock);
+		if (const FEntry* Entry = Chains.Find(Key))
+		{
+			return Entry->Metadata;
+		}
+	}
+
+	TSharedRef<FCurveIKChainMetadata, ESPMode::ThreadSafe> Metadata = MakeShared<FCurveIKChainMetadata, ESPMode::ThreadSafe>();
+	if (!FCurveIKChainMetadata::Build(RefSkeleton, RootBone, TipBone, *Metadata))
+	{
+		return nullptr;
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	FEntry& Entry = Chains.Add(Key);
+	Entry.Metadata = Metadata;
+	return Metadata;
+}
+
+TSharedPtr<const FCurveIKHeightCurve, ESPMode::ThreadSafe> FCurveIKChainCache::FindOrAddHeightCurve(const FKey& Chain, const FCurveIKHeightCurve::FSettings& Settings)
+{
+	auto FindHeightCurve = [&Settings](FEntry& Entry) -> TSharedPtr<const FCurveIKHeightCurve, ESPMode::ThreadSafe>
+	{
+		const int32 Index = Entry.HeightCurves.IndexOfByPredicate([&Settings](const TSharedPtr<const FCurveIKHeightCurve, ESPMode::ThreadSafe>& HeightCurve)
+		{
+			return HeightCurve->GetSettings() == Settings;
+		});
+		if (Index == INDEX_NONE)
+		{
+			return nullptr;
+		}
+
+		TSharedPtr<const FCurveIKHeightCurve, ESPMode::ThreadSafe> HeightCurve = Entry.HeightCurves[Index];
+		Entry.HeightCurves.RemoveAt(Index, 1, false);
+		Entry.HeightCurves.Add(HeightCurve);
+		return HeightCurve;
+	};
+
+	{
+		FScopeLock ScopeLock(&Lock);
+		FEntry* Entry = Chains.Find(Chain);
+		if (TSharedPtr<const FCurveIKHeightCurve, ESPMode::ThreadSafe> HeightCurve = Entry ? FindHeightCurve(*Entry) : nullptr)
+		{
+			return HeightCurve;
+		}
+	}
+
+	TSharedRef<const FCurveIKHeightCurve, ESPMode::ThreadSafe> HeightCurve = MakeShared<const FCurveIKHeightCurve, ESPMode::ThreadSafe>(Settings);
+
+	FScopeLock ScopeLock(&Lock);
+	FEntry* Entry = Chains.Find(Chain);
+	if (!Entry)
+	{
+		return HeightCurve;
+	}
+
+	// Another node on the chain may have fitted the same curve meanwhile
+	if (TSharedPtr<const FCurveIKHeightCurve, ESPMode::ThreadSafe> ExistingHeightCurve = FindHeightCurve(*Entry))
+	{
+		return ExistingHeightCurve;
+	}
+
+	if (Entry->HeightCurves.Num() == MaxHeightCurvesPerChain)
+	{
+		Entry->HeightCurves.RemoveAt(0, 1, false);
+	}
+	Entry->HeightCurves.Add(HeightCurve);
+	return HeightCurve;
+}
+
+void FCurveIKChainCache::Remove(const UObject* Asset)
+{
+	const TObjectKey<UObject> AssetKey(Asset);
+	FScopeLock ScopeLock(&Lock);
+	for (auto It = Chains.CreateIterator(); It; ++It)
+	{
+		if (It.Key().Asset == AssetKey)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+/** The reference skeleton of an asset that chains are gathered on, or null if it has none */
+static const FReferenceSkeleton* GetReferenceSkeleton(const UObject* Asset)
+{
+	if (const USkeletalMesh* SkeletalMesh = Cast<USkeletalMesh>(Asset))
+	{
+		return &SkeletalMesh->RefSkeleton;
+	}
+	if (const USkeleton* Skeleton = Cast<USkeleton>(Asset))
+	{
+		return &Skeleton->GetReferenceSkeleton();
+	}
+	return nullptr;
+}
+
+void FCurveIKChainCache::RemoveStale()
+{
+	FScopeLock ScopeLock(&Lock);
+	for (auto It = Chains.CreateIterator(); It; ++It)
+	{
+		// A bone count check alone misses reimports that move bones or rename them in place
+		const UObject* Asset = It.Key().Asset.ResolveObjectPtr();
+		const FReferenceSkeleton* RefSkeleton = GetReferenceSkeleton(Asset);
+		const FCurveIKChainMetadata& Metadata = *It.Value().Metadata;
+		if (!RefSkeleton || Metadata.RefPoseHash != FCurveIKChainMetadata::HashRefPose(*RefSkeleton, Metadata.RefSkeletonIndices))
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+int32 FCurveIKChainCache::Num()
+{
+	FScopeLock ScopeLock(&Lock);
+	return Chains.Num();
+}
+
+SIZE_T FCurveIKChainCache::GetAllocatedSize()
+{
+	FScopeLock ScopeLock(&Lock);
+	SIZE_T Size = Chains.GetAllocatedSize();
+	for (const TPair<FKey, FEntry>& Pair : Chains)
+	{
+		Size += sizeof(FCurveIKChainMetadata) + Pair.Value.Metadata->GetAllocatedSize()
+			+ Pair.Value.HeightCurves.GetAllocatedSize() + Pair.Value.HeightCurves.Num() * sizeof(FCurveIKHeightCurve);
+	}
+	return Size;
+}
@@ -0,0 +1,7 @@
+#include "CurveIKCustomVersion.h"
+#include "Serialization/CustomVersion.h"
+
+const FGuid FCurveIKCustomVersion::GUID(0x9DA588E8, 0x4AA04FF9, 0x834A9C0A, 0x345D9F28);
+
+// Register the custom version with core
+FCustomVersionRegistration GRegisterCurveIKCustomVersion(FCurveIKCustomVersion::GUID, FCurveIKCustomVersion::LatestVersion, TEXT("CurveIKVer"));
@@ -0,0 +1,89 @@
+#include "CurveIKDebugChannel.h"
+#include "Misc/ScopeLock.h"
+
+/** Number of solve times kept for the edit mode's cost overlay */
+static const int32 SolveTimeHistorySize = 120;
+
+/** True if any link of NewChain was placed or oriented differently from OldChain */
+static bool HasChainMoved(const TArray<FCurveIKChainLink>& OldChain, const TArray<FCurveIKChainLink>& NewChain)
+{
+	if (OldChain.Num() != NewChain.Num())
+	{
+		return true;
+	}
+
+	for (int32 LinkIndex = 0; LinkIndex < NewChain.Num(); LinkIndex++)
+	{
+		if (!OldChain[LinkIndex].Position.Equals(NewChain[LinkIndex].Position)
+			|| !OldChain[LinkIndex].BoneDownVector.Equals(NewChain[LinkIndex].BoneDownVector))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void FCurveIKDebugChannel::Publish(const FCurveIKDebugData& CurveIKDebugData, const TArray<FCurveIKChainLink>& Chain)
+{
+	// Only the anim worker replaces the snapshot, so the one read here stays the latest until it is swapped below
+	TSharedPtr<const FCurveIKDebugSnapshot, ESPMode::ThreadSafe> PreviousSnapshot = GetSnapshot();
+	if (PreviousSnapshot.IsValid() && !HasChainMoved(PreviousSnapshot->Chain, Chain))
+	{
+		return;
+	}
+
+	TSharedRef<FCurveIKDebugSnapshot, ESPMode::ThreadSafe> NewSnapshot = MakeShared<FCurveIKDebugSnapshot, ESPMode::ThreadSafe>();
+	NewSnapshot->CurveIKDebugData = CurveIKDebugData;
+	NewSnapshot->Chain = Chain;
+	NewSnapshot->Version = PreviousSnapshot.IsValid() ? PreviousSnapshot->Version + 1 : 1;
+
+	FScopeLock ScopeLock(&Lock);
+	Snapshot = NewSnapshot;
+}
+
+TSharedPtr<const FCurveIKDebugSnapshot, ESPMode::ThreadSafe> FCurveIKDebugChannel::GetSnapshot() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Snapshot;
+}
+
+void FCurveIKDebugChannel::AddSolve(float SolveTimeMs, const FCurveIKSolveResult& Result)
+{
+	FScopeLock ScopeLock(&Lock);
+	if (SolveTimesMs.Num() < SolveTimeHistorySize)
+	{
+		SolveTimesMs.Add(SolveTimeMs);
+	}
+	else
+	{
+		SolveTimesMs[SolveTimesIndex] = SolveTimeMs;
+		SolveTimesIndex = (SolveTimesIndex + 1) % SolveTimeHistorySize;
+	}
+	LastResult = Result;
+}
+
+void FCurveIKDebugChannel::GetSolves(TArray<float>& OutSolveTimesMs, FCurveIKSolveResult& OutLastResult) const
+{
+	FScopeLock ScopeLock(&Lock);
+	OutSolveTimesMs.Reset(SolveTimesMs.Num());
+	for (int32 Sample = 0; Sample < SolveTimesMs.Num(); Sample++)
+	{
+		OutSolveTimesMs.Add(SolveTimesMs[(SolveTimesIndex + Sample) % SolveTimesMs.Num()]);
+	}
+	if (SolveTimesMs.Num() > 0)
+	{
+		OutLastResult = LastResult;
+	}
+}
+
+SIZE_T FCurveIKDebugChannel::GetAllocatedSize() const
+{
+	FScopeLock ScopeLock(&Lock);
+	SIZE_T Size = SolveTimesMs.GetAllocatedSize();
+	if (Snapshot.IsValid())
+	{
+		Size += sizeof(FCurveIKDebugSnapshot) + Snapshot->CurveIKDebugData.GetAllocatedSize()
+			+ CurveIK_AnimationCore::GetChainAllocatedSize(Snapshot->Chain);
+	}
+	return Size;
+}
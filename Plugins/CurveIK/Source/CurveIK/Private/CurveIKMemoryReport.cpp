@@ -0,0 +1,91 @@
+#include "CoreMinimal.h"
+#include "AnimNode_CurveIK.h"
+#include "CurveIKChainCache.h"
+#include "CurveIKSharedCurveCache.h"
+#include "Animation/AnimClassInterface.h"
+#include "Animation/AnimInstance.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+
+namespace CurveIKMemoryReport
+{
+	struct FClassTotals
+	{
+		int32 NumInstances = 0;
+		int32 NumNodes = 0;
+		SIZE_T NumBytes = 0;
+	};
+
+	/** Lists the memory of the CurveIK nodes in World, totalled per anim blueprint, followed by the process-wide caches */
+	static void Run(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		TMap<const UClass*, FClassTotals> Totals;
+		for (TObjectIterator<UAnimInstance> It; It; ++It)
+		{
+			// Defaults and archetypes are never evaluated, and are not instances of their anim blueprint
+			const UAnimInstance* AnimInstance = *It;
+			if (AnimInstance->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+			{
+				continue;
+			}
+
+			const IAnimClassInterface* AnimClass = IAnimClassInterface::GetFromClass(AnimInstance->GetClass());
+			if (!AnimClass || (World && AnimInstance->GetWorld() != World))
+			{
+				continue;
+			}
+
+			FClassTotals* ClassTotals = nullptr;
+			for (const UStructProperty* Property : AnimClass->GetAnimNodeProperties())
+			{
+				if (!Property->Struct->IsChildOf(FAnimNode_CurveIK::StaticStruct()))
+				{
+					continue;
+				}
+
+				if (!ClassTotals)
+				{
+					ClassTotals = &Totals.FindOrAdd(AnimInstance->GetClass());
+					ClassTotals->NumInstances++;
+				}
+
+				// The node itself lives in the anim instance, its arrays on the heap
+				const FAnimNode_CurveIK* Node = Property->ContainerPtrToValuePtr<FAnimNode_CurveIK>(AnimInstance);
+				ClassTotals->NumNodes++;
+				ClassTotals->NumBytes += sizeof(FAnimNode_CurveIK) + Node->GetAllocatedSize();
+			}
+		}
+
+		Totals.ValueSort([](const FClassTotals& A, const FClassTotals& B)
+		{
+			return A.NumBytes > B.NumBytes;
+		});
+
+		Ar.Logf(TEXT("CurveIK memory per anim blueprint:"));
+		Ar.Logf(TEXT("%12s %10s %8s  %s"), TEXT("KB"), TEXT("Instances"), TEXT("Nodes"), TEXT("Class"));
+
+		FClassTotals AllTotals;
+		for (const TPair<const UClass*, FClassTotals>& Pair : Totals)
+		{
+			const FClassTotals& ClassTotals = Pair.Value;
+			Ar.Logf(TEXT("%12.2f %10d %8d  %s"), ClassTotals.NumBytes / 1024.f, ClassTotals.NumInstances, ClassTotals.NumNodes, *Pair.Key->GetPathName());
+			AllTotals.NumInstances += ClassTotals.NumInstances;
+			AllTotals.NumNodes += ClassTotals.NumNodes;
+			AllTotals.NumBytes += ClassTotals.NumBytes;
+		}
+		Ar.Logf(TEXT("%12.2f %10d %8d  Total"), AllTotals.NumBytes / 1024.f, AllTotals.NumInstances, AllTotals.NumNodes);
+
+		// Shared by every world, so they are reported once rather than split between anim blueprints
+		FCurveIKChainCache& ChainCache = FCurveIKChainCache::Get();
+		FCurveIKSharedCurveCache& SharedCurveCache = FCurveIKSharedCurveCache::Get();
+		Ar.Logf(TEXT("CurveIK shared caches:"));
+		Ar.Logf(TEXT("%12.2f KB in %d chains  Chain cache"), ChainCache.GetAllocatedSize() / 1024.f, ChainCache.Num());
+		Ar.Logf(TEXT("%12.2f KB in %d curves  Shared curve cache"), SharedCurveCache.GetAllocatedSize() / 1024.f, SharedCurveCache.Num());
+	}
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CurveIKMemReportCommand(
+	TEXT("CurveIK.MemReport"),
+	TEXT("Lists the memory used by the CurveIK nodes of the current world, totalled per anim blueprint, and by the caches they share."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&CurveIKMemoryReport::Run));
@@ -0,0 +1,134 @@
+#include "CoreMinimal.h"
+#include "AnimNode_CurveIK.h"
+#include "Animation/Skeleton.h"
+#include "Engine/SkeletalMesh.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/Package.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace AnimNodeCurveIKTest
+{
+	static const int32 NumBones = 12;
+	static const float BoneLength = 10.f;
+
+	/** Allowed difference between an output bone's distance to its parent and its bone length */
+	static const float BoneLengthTolerance = 0.1f * BoneLength;
+
+	/** Effectors up to this fraction of the chain's reach away from the root must be reached */
+	static const float ReachableFraction = 0.95f;
+
+	/** Allowed distance between the tip bone and a reachable effector, as a fraction of the chain's reach */
+	static const float TipTolerance = 0.02f;
+
+	/** Mean time budget per evaluation, including the solve. Deliberately loose, like the solver's budget. */
+	static const double EvaluateBudgetMicroseconds = 200.0;
+
+	static const int32 NumEvaluations = 5000;
+
+	/** A transient mesh and skeleton holding a straight chain of NumBones bones along X */
+	static USkeletalMesh* MakeChainMesh()
+	{
+		USkeletalMesh* Mesh = NewObject<USkeletalMesh>(GetTransientPackage(), NAME_None, RF_Transient);
+		{
+			FReferenceSkeletonModifier Modifier(Mesh->RefSkeleton, nullptr);
+			for (int32 BoneIndex = 0; BoneIndex < NumBones; BoneIndex++)
+			{
+				const FName BoneName(*FString::Printf(TEXT("chain_%02d"), BoneIndex));
+				Modifier.Add(FMeshBoneInfo(BoneName, BoneName.ToString(), BoneIndex - 1),
+				             FTransform(FVector(BoneIndex == 0 ? 0.f : BoneLength, 0.f, 0.f)));
+			}
+		}
+
+		USkeleton* Skeleton = NewObject<USkeleton>(GetTransientPackage(), NAME_None, RF_Transient);
+		Skeleton->MergeAllBonesToBoneTree(Mesh);
+		Mesh->Skeleton = Skeleton;
+		return Mesh;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAnimNodeCurveIKTest, "CurveIK.AnimNode.Evaluate",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::PerfFilter)
+
+bool FAnimNodeCurveIKTest::RunTest(const FString& Parameters)
+{
+	using namespace AnimNodeCurveIKTest;
+
+	USkeletalMesh* Mesh = MakeChainMesh();
+	const FReferenceSkeleton& RefSkeleton = Mesh->RefSkeleton;
+
+	TArray<FBoneIndexType> RequiredBoneIndices;
+	for (int32 BoneIndex = 0; BoneIndex < RefSkeleton.GetNum(); BoneIndex++)
+	{
+		RequiredBoneIndices.Add(BoneIndex);
+	}
+	FBoneContainer BoneContainer(RequiredBoneIndices, FCurveEvaluationOption(false), *Mesh);
+
+	FAnimNode_CurveIK Node;
+	Node.RootBone = FBoneReference(RefSkeleton.GetBoneName(0));
+	Node.TipBone = FBoneReference(RefSkeleton.GetBoneName(NumBones - 1));
+	Node.EffectorLocationSpace = BCS_ComponentSpace;
+	Node.InitializeBones(BoneContainer);
+
+	if (!TestTrue(TEXT("Node is valid to evaluate"), Node.IsValidToEvaluate(Mesh->Skeleton, BoneContainer)))
+	{
+		return false;
+	}
+
+	FCompactPose Pose;
+	Pose.SetBoneContainer(&BoneContainer);
+	Pose.ResetToRefPose();
+	FCSPose<FCompactPose> ComponentPose;
+	TArray<FBoneTransform> BoneTransforms;
+
+	const float MaximumReach = BoneLength * (NumBones - 1);
+	FRandomStream Random(0);
+	int32 NumLengthErrors = 0;
+	int32 NumTipErrors = 0;
+	double EvaluateSeconds = 0.0;
+
+	for (int32 Evaluation = 0; Evaluation < NumEvaluations; Evaluation++)
+	{
+		Node.EffectorLocation = Random.GetUnitVector() * MaximumReach * Random.FRandRange(0.3f, 1.3f);
+		ComponentPose.InitPose(Pose);
+		BoneTransforms.Reset();
+
+		const double StartTime = FPlatformTime::Seconds();
+		Node.EvaluateComponentSpace(FTransform::Identity, ComponentPose, BoneTransforms);
+		EvaluateSeconds += FPlatformTime::Seconds() - StartTime;
+
+		if (!TestEqual(TEXT("Every chain bone is output"), BoneTransforms.Num(), NumBones))
+		{
+			return false;
+		}
+
+		for (int32 BoneIndex = 1; BoneIndex < BoneTransforms.Num(); BoneIndex++)
+		{
+			const float Length = FVector::Dist(BoneTransforms[BoneIndex].Transform.GetLocation(), BoneTransforms[BoneIndex - 1].Transform.GetLocation());
+			if (FMath::Abs(Length - BoneLength) > BoneLengthTolerance && NumLengthErrors++ == 0)
+			{
+				AddError(FString::Printf(TEXT("Evaluation %d: bone %d is %f from its parent instead of %f"), Evaluation, BoneIndex, Length, BoneLength));
+			}
+		}
+
+		// The root stays at the origin, so the effector's distance from it tells whether it is in reach
+		const float TipError = FVector::Dist(BoneTransforms.Last().Transform.GetLocation(), Node.EffectorLocation);
+		if (Node.EffectorLocation.Size() <= ReachableFraction * MaximumReach && TipError > TipTolerance * MaximumReach && NumTipErrors++ == 0)
+		{
+			AddError(FString::Printf(TEXT("Evaluation %d: tip is %f from an effector in reach, chain reach %f"), Evaluation, TipError, MaximumReach));
+		}
+	}
+
+	TestEqual(TEXT("Evaluations with a bone length error"), NumLengthErrors, 0);
+	TestEqual(TEXT("Evaluations missing an effector in reach"), NumTipErrors, 0);
+
+	const double MeanMicroseconds = EvaluateSeconds * 1000000.0 / NumEvaluations;
+	AddInfo(FString::Printf(TEXT("%.2f us per evaluation, budget %.2f us"), MeanMicroseconds, EvaluateBudgetMicroseconds));
+	TestTrue(TEXT("Mean evaluation time is within budget"), MeanMicroseconds <= EvaluateBudgetMicroseconds);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -5,12 +5,20 @@
 #include "BoneIndices.h"
 #include "BoneContainer.h"
 #include "BonePose.h"
+#include "CurveIKChainCache.h"
+#include "CurveIKColliders.h"
 #include "CurveIKCore.h"
-#include "IKCurves/IKCurve.h"
+#include "CurveIKDebugChannel.h"
+#include "CurveIKTrace.h"
+#include "CurveIKTypes.h"
 #include "BoneControllers/AnimNode_SkeletalControlBase.h"
 #include "AnimNode_CurveIK.generated.h"
 
 class FPrimitiveDrawInterface;
+class UPhysicsAsset;
+struct FCurveIKAsyncSolve;
+class FCurveIKHeightCurve;
+class UCurveIKBudgetSubsystem;
 class USkeletalMeshComponent;
 
 USTRUCT()
@@ -39,20 +47,76 @@ struct FCurveIK_CachedBoneData
 	int32 RefSkeletonIndex;
 };
 
+/** A capsule or sphere attached to a bone, which the curve is steered around */
+USTRUCT()
+struct FCurveIKCollider
+{
+	GENERATED_BODY()
+
+	/** The bone the collider moves with */
+	UPROPERTY(EditAnywhere, Category = Collision)
+	FBoneReference Bone;
+
+	/** One end of the capsule, in bone space */
+	UPROPERTY(EditAnywhere, Category = Collision)
+	FVector Start = FVector::ZeroVector;
+
+	/** The other end of the capsule, in bone space. Leave it equal to Start for a sphere. */
+	UPROPERTY(EditAnywhere, Category = Collision)
+	FVector End = FVector::ZeroVector;
+
+	UPROPERTY(EditAnywhere, Category = Collision, meta = (ClampMin = "0"))
+	float Radius = 10.f;
+};
+
+/** A solved chain and the root and effector it was solved against, so it can be applied on a later frame */
+struct CURVEIK_API FCurveIKSolvedChain
+{
+	/** Link positions and the curve points they lie on, in component space */
+	TArray<FVector> Positions;
+	TArray<FCurvePoint> CurvePoints;
+
+	/** Component space transform of the root bone the chain was solved from */
+	FTransform RootTransform;
+
+	/** The effector the chain was solved towards, relative to RootTransform */
+	FVector RootSpaceEffector = FVector::ZeroVector;
+
+	bool IsValid() const { return Positions.Num() > 0; }
+	void Reset();
+
+	/** Records the solved links of Chain, along with the root transform and effector they were solved for */
+	void Capture(const TArray<FCurveIKChainLink>& Chain, const FTransform& InRootTransform, const FVector& Effector);
+
+	/**
+	 * Moves InOutChain onto the solved chain, carried rigidly from RootTransform onto InRootTransform so that the
+	 * root's rotation is followed as well as its translation. Returns false if the chain has a different number of links.
+	 */
+	bool Apply(TArray<FCurveIKChainLink>& InOutChain, const FTransform& InRootTransform) const;
+
+	/** Distance from Effector to the effector the chain was solved towards, once carried onto InRootTransform */
+	float GetEffectorDrift(const FTransform& InRootTransform, const FVector& Effector) const;
+
+	SIZE_T GetAllocatedSize() const { return Positions.GetAllocatedSize() + CurvePoints.GetAllocatedSize(); }
+};
+
 USTRUCT(BlueprintType)
 struct CURVEIK_API FAnimNode_CurveIK : public FAnimNode_SkeletalControlBase
 {
 	GENERATED_USTRUCT_BODY()
 
-	/** The location that the IK system attempts to extend towards */
+	/** The location that the IK system attempts to extend towards, in EffectorLocationSpace */
 	UPROPERTY(EditAnywhere, Category = Effector, meta = (PinShownByDefault))
 	FVector EffectorLocation;
 
-	/** A draggable target used in editing */
+	/** The bone or socket that EffectorLocation is relative to in bone and parent bone space */
 	UPROPERTY(EditAnywhere, Category = Effector)
 	FBoneSocketTarget EffectorTarget;
 
-	/** Controls the interpretation of FAnimNode_CurveIK::EffectorLocation */
+	/**
+	 * Controls the interpretation of FAnimNode_CurveIK::EffectorLocation. Effectors are resolved on the anim worker,
+	 * so following a bone or socket only needs EffectorTarget and a constant offset, with no Blueprint logic.
+	 */
 	UPROPERTY(EditAnywhere, Category = Effector)
 	TEnumAsByte<enum EBoneControlSpace> EffectorLocationSpace;
 
@@ -76,13 +140,20 @@ struct CURVEIK_API FAnimNode_CurveIK : public FAnimNode_SkeletalControlBase
 	FBoneReference RootBone;
 
 	/** Maximum number of iterations allowed, to control performance. */
-	UPROPERTY(EditAnywhere, Category = Solver)
+	UPROPERTY(EditAnywhere, Category = Solver, meta = (ClampMin = "1"))
 	int32 MaxIterations;
 
 	/** The number of points used to approximate the curve. Higher values impact both compute times and memory. */
 	UPROPERTY(EditAnywhere, Category = Solver)
 	int32 CurveDetail;
 
+	/**
+	 * Maximum distance in cm between the sampled curve and the true curve. When greater than zero, each solve derives
+	 * its sample count from the curve's shape and CurveDetail is ignored: straight curves use few samples, tight bends more.
+	 */
+	UPROPERTY(EditAnywhere, Category = Solver, meta = (ClampMin = "0", UIMin = "0"))
+	float MaxCurveError;
+
 	/** Allowable delta between arc length of the curve and arc length as the sum of bone lengths */
 	UPROPERTY(EditAnywhere, Category = Solver)
 	float CurveFitTolerance;
@@ -95,6 +166,75 @@ struct CURVEIK_API FAnimNode_CurveIK : public FAnimNode_SkeletalControlBase
 	UPROPERTY(EditAnywhere, Category = Solver, meta = (ClampMin = "-360", ClampMax = "360", UIMin = "-360", UIMax = "360"))
 	float HandleAngle;
 
+	/**
+	 * Share fitted curves with every other CurveIK node that uses the same settings. Chains of the same archetype then
+	 * mostly reuse a cached curve instead of fitting one. The curve stays within CurveFitTolerance of the chain length.
+	 */
+	UPROPERTY(EditAnywhere, Category = Solver)
+	bool bUseSharedCurveCache;
+
+	/**
+	 * Fit the chain at a handful of root to effector distances when the node is initialized, and start every solve
+	 * from the handle height interpolated between them. Solves then mostly evaluate two curves, so their cost hardly
+	 * varies. Takes precedence over bUseSharedCurveCache. The fit is shared by every node on the same chain with the
+	 * same settings, and changing a solver setting refits the chain on the next solve.
+	 */
+	UPROPERTY(EditAnywhere, Category = Solver)
+	bool bPrecomputeHandleHeights;
+
+	/**
+	 * Solve on a task graph thread, overlapping with the rest of the frame. Each frame applies the latest finished solve,
+	 * so the chain trails the effector by a frame, or more while the task graph is busy. Suited to tails, antennae and
+	 * other cosmetic chains.
+	 */
+	UPROPERTY(EditAnywhere, Category = Solver)
+	bool bAsyncSolve;
+
+	/**
+	 * How far in cm the effector may move relative to the root while an async solve runs. When it moves further,
+	 * the result is dropped and the chain is solved in place instead, so fast effector movement does not lag.
+	 */
+	UPROPERTY(EditAnywhere, Category = Solver, meta = (ClampMin = "0", UIMin = "0", EditCondition = "bAsyncSolve"))
+	float AsyncMaxEffectorDrift;
+
+	/**
+	 * Steer the curve around colliders by rotating its bend about the line from root to effector. Colliders that
+	 * contain the root or the effector cannot be avoided and are ignored.
+	 */
+	UPROPERTY(EditAnywhere, Category = Collision)
+	bool bAvoidCollisions;
+
+	/** The thickness of the chain, kept clear of every collider */
+	UPROPERTY(EditAnywhere, Category = Collision, meta = (ClampMin = "0"))
+	float CollisionRadius;
+
+	/** Avoid the sphere and capsule bodies of the mesh's physics asset, apart from those on bones of the chain */
+	UPROPERTY(EditAnywhere, Category = Collision)
+	bool bUsePhysicsAssetColliders;
+
+	/** Extra colliders to avoid */
+	UPROPERTY(EditAnywhere, Category = Collision)
+	TArray<FCurveIKCollider> Colliders;
+
+	/**
+	 * How important this chain is, from 0 to 1. Once the world's CurveIK.Budget.Microseconds is set, the node only solves
+	 * at full quality while less than this fraction of the frame's budget has been used. Drive it from a significance manager.
+	 */
+	UPROPERTY(EditAnywhere, Category = Budget, meta = (ClampMin = "0", ClampMax = "1", UIMin = "0", UIMax = "1", PinHiddenByDefault))
+	float Significance;
+
+	/** What to do when this frame's budget has run out before the node solves */
+	UPROPERTY(EditAnywhere, Category = Budget)
+	ECurveIKOverBudgetPolicy OverBudgetPolicy;
+
+	/** Maximum iterations when solving over budget */
+	UPROPERTY(EditAnywhere, Category = Budget, meta = (ClampMin = "1"))
+	int32 OverBudgetMaxIterations;
+
+	/** Number of points sampled on each curve when solving over budget */
+	UPROPERTY(EditAnywhere, Category = Budget, meta = (ClampMin = "2"))
+	int32 OverBudgetCurveDetail;
+
 #if WITH_EDITORONLY_DATA
 	UPROPERTY(EditAnywhere, Category = Debug)
 	/** Toggle drawing of axes to debug joint rotation*/
@@ -116,6 +256,12 @@ struct CURVEIK_API FAnimNode_CurveIK : public FAnimNode_SkeletalControlBase
 public:
 	FAnimNode_CurveIK();
 
+	/** Declares FCurveIKCustomVersion and falls back to tagged property serialization */
+	bool Serialize(FArchive& Ar);
+
+	/** Moves nodes saved before EffectorLocationSpace was honoured to the component space they were solved in */
+	void PostSerialize(const FArchive& Ar);
+
 	// FAnimNode_Base interface
 	virtual void GatherDebugData(FNodeDebugData& DebugData) override;
 	virtual void Initialize_AnyThread(const FAnimationInitializeContext& Context) override;
@@ -128,15 +274,52 @@ public:
 
 	virtual void ConditionalDebugDraw(FPrimitiveDrawInterface* PDI, USkeletalMeshComponent* PreviewSkelMeshComp) const;
 
+	/**
+	 * Initializes the chain's bone references against RequiredBones and solves the chain in Pose, without an anim
+	 * instance. Used by offline tools such as baking. Physics asset colliders are not gathered. The solved transforms
+	 * are not blended with Pose, which the anim graph does by the node's alpha at runtime.
+	 */
+	void InitializeBones(const FBoneContainer& RequiredBones) { InitializeBoneReferences(RequiredBones); }
+	void EvaluateComponentSpace(const FTransform& ComponentTransform, FCSPose<FCompactPose>& Pose, TArray<FBoneTransform>& OutBoneTransforms);
+
+	/**
+	 * Solves the chain like EvaluateComponentSpace, but returns the local transforms of the chain's bones. Only the root
+	 * and its ancestors are resolved to component space in Pose. The rest of the chain is built up from Pose's local
+	 * transforms, and the solved transforms are turned back into local ones in a single pass. Write them straight into
+	 * a local pose instead of setting component space transforms on Pose and converting the whole pose back. They are
+	 * blended with Pose by Alpha, as the anim graph would, since offline callers do not update the node's alpha inputs.
+	 */
+	void EvaluateLocalSpace(const FTransform& ComponentTransform, FCSPose<FCompactPose>& Pose, TArray<FBoneTransform>& OutBoneTransforms);
+
+	/**
+	 * Heap memory owned by this node instance: cached bone data, colliders, async and last solve state, the handle height
+	 * curve and debug data. Chain metadata and curves shared with other nodes are reported by their caches instead.
+	 */
+	SIZE_T GetAllocatedSize() const;
+
+	/**
+	 * Replaces the colliders the node avoids. They are rebuilt on the next evaluation, without initializing the node
+	 * again. Used by editor previews, which are not reinitialized when a property changes. Call on the game thread.
+	 */
+	void SetColliders(const TArray<FCurveIKCollider>& InColliders, bool bInUsePhysicsAssetColliders);
+
+	/** Outcome of the most recent solve, for debugging and telemetry */
+	const FCurveIKSolveResult& GetLastSolveResult() const { return LastSolveResult; }
+
 private:
 	// FAnimNode_SkeletalControlBase interface
 	virtual void InitializeBoneReferences(const FBoneContainer& RequiredBones) override;
-	void GatherBoneReferences(const FReferenceSkeleton& RefSkeleton);
-	void GatherBoneLengths(const FReferenceSkeleton& RefSkeleton);
+	void GatherBoneReferences(const FBoneContainer& RequiredBones);
 	// End of FAnimNode_SkeletalControlBase interface
 
-	// Convenience function to get current (pre-translation iteration) component space location of bone by bone index
-	FVector GetCurrentLocation(FCSPose<FCompactPose>& MeshBases, const FCompactPoseBoneIndex& BoneIndex);
+	/**
+	 * Gathers the chain from Pose, solves it and writes the solved component space transforms of its bones. With
+	 * bChainFromLocalPose, only the root is read in component space from Pose and the bones below it are built from
+	 * their local transforms.
+	 */
+	void EvaluateChain(const FTransform& ComponentTransform, FCSPose<FCompactPose>& Pose, bool bChainFromLocalPose,
+	                   TArray<FBoneTransform>& OutBoneTransforms);
+
 	static FTransform GetTargetTransform(const FTransform& InComponentTransform, FCSPose<FCompactPose>& MeshBases, FBoneSocketTarget& InTarget, EBoneControlSpace Space, const FTransform& InOffset);
 
 	/** Cached data for bones in the IK chain, from start to end */
@@ -145,12 +328,121 @@ private:
 	/** Cached bone lengths. Same size as CachedBoneReferences */
 	TArray<float> CachedBoneLengths;
 
+	/** The chain in FCurveIKChainCache that CachedBoneReferences was gathered from */
+	FCurveIKChainCache::FKey ChainKey;
+
+	/** Result of the most recent call to SolveCurveIK */
+	FCurveIKSolveResult LastSolveResult;
 
-#if WITH_EDITOR
+	/**
+	 * Moves the async solve into LastSolve if it has finished. Never waits: a solve still running is left in flight and
+	 * LastSolve stays as it is.
+	 *
+	 * @return Whether LastSolve holds a solve to apply
+	 */
+	bool CollectAsyncSolve(FCurveIKDebugData* DebugData);
+
+	/** Whether an async solve has been kicked and not collected yet */
+	bool IsAsyncSolveInFlight() const;
+
+	/** Starts solving Chain towards TargetLocation on a task graph thread, to be applied next frame */
+	void KickAsyncSolve(const TArray<FCurveIKChainLink>& Chain, const FTransform& RootTransform, const FVector& TargetLocation,
+	                    float MaximumReach, const TSharedPtr<const FCurveIKColliders, ESPMode::ThreadSafe>& InColliders,
+	                    bool bCaptureDebugData, int32 TraceStreamId);
+
+	/** The async solve in flight, if any. Kept between solves to reuse its allocations. */
+	TSharedPtr<FCurveIKAsyncSolve, ESPMode::ThreadSafe> AsyncSolve;
+
+	/** Whether bAsyncSolve was set on the last evaluation, so results kicked before it was toggled are dropped */
+	bool bAsyncSolveWasEnabled = false;
+
+	/**
+	 * The most recent solve, for async solves to apply on the next frame and for ECurveIKOverBudgetPolicy::ReuseLastResult
+	 * to carry along with the root
+	 */
+	FCurveIKSolvedChain LastSolve;
+
+	/** The world's CurveIK budget, if the node runs in a world. Resolved once per evaluation. */
+	TWeakObjectPtr<UCurveIKBudgetSubsystem> BudgetSubsystem;
+
+	/** Running average of this node's solve cost, reserved from the budget before each solve. Zero until a solve is measured. */
+	uint32 EstimatedSolveCycles = 0;
+
+	/** Folds a measured solve into EstimatedSolveCycles */
+	void UpdateEstimatedSolveCycles(uint32 SolveCycles);
+
+	/** Handle heights fitted for this chain and the current solver settings. Shared with async solves and other nodes. */
+	TSharedPtr<const FCurveIKHeightCurve, ESPMode::ThreadSafe> HeightCurve;
+
+	/** Finds or fits HeightCurve in FCurveIKChainCache if the solver settings or MaximumReach changed since it was fitted */
+	void UpdateHeightCurve(float MaximumReach);
+
+	/** Adds the sphere and capsule bodies of PhysicsAsset to PhysicsAssetColliders */
+	void GatherPhysicsAssetColliders(const UPhysicsAsset* InPhysicsAsset);
+
+	/** Rebuilds ActiveColliders from Colliders and PhysicsAssetColliders */
+	void UpdateActiveColliders(const FBoneContainer& RequiredBones);
+
+	/**
+	 * Moves SolveColliders to the current bone transforms. Only refits the BVH when a bone moved, and only rebuilds
+	 * it when ActiveColliders changed.
+	 */
+	void UpdateSolveColliders(FCSPose<FCompactPose>& MeshBases);
+
+	/** The owning component's physics asset when the node was initialized */
+	TWeakObjectPtr<UPhysicsAsset> PhysicsAsset;
+
+	/** Colliders taken from the physics asset when the node was initialized */
+	TArray<FCurveIKCollider> PhysicsAssetColliders;
+
+	/** Colliders and physics asset colliders with initialized bone references */
+	TArray<FCurveIKCollider> ActiveColliders;
+
+	/** Set by SetColliders, so ActiveColliders is rebuilt on the next evaluation */
+	bool bActiveCollidersDirty = false;
+
+	/**
+	 * Component space colliders handed to the solver. Shared with the async solve in flight, so they are only copied
+	 * when they move while it still reads them.
+	 */
+	TSharedPtr<FCurveIKColliders, ESPMode::ThreadSafe> SolveColliders;
+
+	/** The index in ActiveColliders of each of SolveColliders, and the transform of its bone when it was placed */
+	TArray<int32> SolveColliderSources;
+	TArray<FTransform> SolveColliderBoneTransforms;
+
+	/** Set when ActiveColliders changed, so SolveColliders and its BVH are built again */
+	bool bSolveCollidersDirty = true;
+
+	/** This node's stream in the CurveIK trace being recorded, if any */
+	FCurveIKTraceStream TraceStream;
+
+	/** The solver settings as recorded in a CurveIK trace */
+	FCurveIKTraceSettings GetTraceSettings() const;
+
+
+#if WITH_EDITORONLY_DATA
 #if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
 public:
+	/**
+	 * Debug data for editor tools on the game thread. Solve times are recorded while the channel is observed,
+	 * and curve data is only captured when bEnableDebugDraw is set as well.
+	 */
+	FCurveIKDebugChannel DebugChannel;
+
+private:
+	/** Filled by the solver on the anim worker, then published through DebugChannel */
 	FCurveIKDebugData CurveIKDebugData;
-	TArray<FCurveIKChainLink> Chain;
 #endif
 #endif
 };
+
+template<>
+struct TStructOpsTypeTraits<FAnimNode_CurveIK> : public TStructOpsTypeTraitsBase2<FAnimNode_CurveIK>
+{
+	enum
+	{
+		WithSerializer = true,
+		WithPostSerialize = true,
+	};
+};
@@ -12,4 +12,11 @@ public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+private:
+	/** Keep FCurveIKChainCache from outliving the meshes its chains were measured on */
+	FDelegateHandle PostGarbageCollectHandle;
+#if WITH_EDITOR
+	FDelegateHandle ObjectPropertyChangedHandle;
+#endif
 };
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Templates/Atomic.h"
+#include "CurveIKBudgetSubsystem.generated.h"
+
+/**
+ * Shares a per-frame solve time budget between every CurveIK node in a world. The budget is set in microseconds with
+ * CurveIK.Budget.Microseconds, and zero disables it.
+ *
+ * Nodes reserve their expected cost before solving and report how long their solve took. A node is refused once the
+ * share of the budget given by its significance has been used, so the most significant nodes keep solving at full
+ * quality the longest. Safe to use from anim worker threads.
+ */
+UCLASS()
+class CURVEIK_API UCurveIKBudgetSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Whether a node may solve at full quality this frame. If it may, EstimatedCycles are charged in the same atomic
+	 * step, so nodes evaluated in parallel cannot all pass the check before any of them has been charged.
+	 *
+	 * @param Significance In [0, 1]. The node is refused once this fraction of the budget has been used.
+	 * @param EstimatedCycles The expected cost of the solve, replaced by its real cost in AddSolveCycles
+	 */
+	bool TryReserve(float Significance, uint32 EstimatedCycles);
+
+	/** Charges a solve that took Cycles to this frame's budget, in place of the ReservedCycles charged for it by TryReserve */
+	void AddSolveCycles(uint32 Cycles, uint32 ReservedCycles = 0);
+
+	/** Time charged to this frame's budget so far */
+	float GetUsedMicroseconds() const;
+
+	/** The budget for each frame, or zero if there is none */
+	static float GetBudgetMicroseconds();
+
+	/**
+	 * What a node reserves for a solve before it has measured one of its own, from CurveIK.Budget.UnmeasuredSolveMicroseconds.
+	 * Errs high, so nodes coming into view together cannot all pass the check on an estimate of zero.
+	 */
+	static uint32 GetUnmeasuredSolveCycles();
+
+private:
+	/** Bits of FrameUsage holding the used cycles. The rest hold the low bits of the frame they were used in. */
+	static const int32 UsedCyclesBits = 40;
+
+	/** Cycles used this frame, or zero if FrameUsage was last written in an earlier frame */
+	static uint64 GetUsedCycles(uint64 FrameUsage, uint64 Frame);
+
+	/** Packs the frame with the cycles used in it, so starting a new frame and charging to it are one atomic step */
+	static uint64 MakeFrameUsage(uint64 Frame, uint64 UsedCycles);
+
+	/** The frame, from GFrameCounter, and the cycles used in it */
+	TAtomic<uint64> FrameUsage;
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CurveIKHeightCurve.h"
+#include "HAL/CriticalSection.h"
+#include "UObject/ObjectKey.h"
+
+struct FReferenceSkeleton;
+
+/** The bones of a chain from RootBone to TipBone and their reference pose lengths */
+struct CURVEIK_API FCurveIKChainMetadata
+{
+	/** Bones from root to tip */
+	TArray<FName> BoneNames;
+	TArray<int32> RefSkeletonIndices;
+
+	/** Distance from each bone to its parent in the reference pose. Zero for the root. */
+	TArray<float> BoneLengths;
+
+	/** Hash of the reference pose the chain was measured in, to detect reimported meshes in RemoveStale */
+	uint32 RefPoseHash = 0;
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return BoneNames.GetAllocatedSize() + RefSkeletonIndices.GetAllocatedSize() + BoneLengths.GetAllocatedSize();
+	}
+
+	/**
+	 * Walks from TipBone up to RootBone and measures the chain. Only the root's ancestors and the chain itself are
+	 * transformed, not the whole skeleton.
+	 *
+	 * @return False if TipBone is not a descendant of RootBone
+	 */
+	static bool Build(const FReferenceSkeleton& RefSkeleton, FName RootBone, FName TipBone, FCurveIKChainMetadata& OutMetadata);
+
+	/**
+	 * Hashes the bone count of RefSkeleton, and the names, parents and reference pose transforms of the chain bones
+	 * and the root's ancestors. Those are all the chain's lengths depend on.
+	 */
+	static uint32 HashRefPose(const FReferenceSkeleton& RefSkeleton, const TArray<int32>& RefSkeletonIndices);
+};
+
+/**
+ * Process-wide cache of chain metadata, keyed on the asset that owns the reference skeleton and the chain's end bones.
+ * Node instances on the same mesh share one entry, so spawning or changing LOD does not remeasure the chain. Handle
+ * heights fitted for the chain are kept with it, per solver settings. Safe to use from any thread.
+ */
+class CURVEIK_API FCurveIKChainCache
+{
+public:
+	/** Identifies a chain */
+	struct FKey
+	{
+		TObjectKey<UObject> Asset;
+		FName RootBone;
+		FName TipBone;
+
+		bool operator==(const FKey& Other) const
+		{
+			return Asset == Other.Asset && RootBone == Other.RootBone && TipBone == Other.TipBone;
+		}
+
+		friend uint32 GetTypeHash(const FKey& Key)
+		{
+			return HashCombine(GetTypeHash(Key.Asset), HashCombine(GetTypeHash(Key.RootBone), GetTypeHash(Key.TipBone)));
+		}
+	};
+
+	static FCurveIKChainCache& Get();
+
+	/**
+	 * Finds or builds the metadata for a chain. Returns null if TipBone is not a descendant of RootBone. Cached chains are
+	 * returned without checking them against RefSkeleton.
+	 */
+	TSharedPtr<const FCurveIKChainMetadata, ESPMode::ThreadSafe> FindOrAdd(const UObject* Asset, const FReferenceSkeleton& RefSkeleton,
+	                                                                      FName RootBone, FName TipBone);
+
+	/**
+	 * Finds or fits the handle heights of a chain for the given solver settings. Fitting runs outside the lock, and a
+	 * curve for a chain that is no longer cached is returned without being kept.
+	 */
+	TSharedPtr<const FCurveIKHeightCurve, ESPMode::ThreadSafe> FindOrAddHeightCurve(const FKey& Chain, const FCurveIKHeightCurve::FSettings& Settings);
+
+	/** Drops the chains of Asset, such as when it is reimported */
+	void Remove(const UObject* Asset);
+
+	/** Drops the chains of assets that have been garbage collected, or whose reference pose changed since they were built */
+	void RemoveStale();
+
+	/** Number of cached chains and the heap memory they use */
+	int32 Num();
+	SIZE_T GetAllocatedSize();
+
+	/** Most height curves kept per chain. The least recently used is dropped first. */
+	static const int32 MaxHeightCurvesPerChain = 4;
+
+private:
+	struct FEntry
+	{
+		TSharedPtr<const FCurveIKChainMetadata, ESPMode::ThreadSafe> Metadata;
+
+		/** Fitted for the chain with different settings, most recently used last */
+		TArray<TSharedPtr<const FCurveIKHeightCurve, ESPMode::ThreadSafe>, TInlineAllocator<MaxHeightCurvesPerChain>> HeightCurves;
+	};
+
+	FCriticalSection Lock;
+	TMap<FKey, FEntry> Chains;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Guid.h"
+
+/** Custom serialization version for changes to CurveIK assets */
+struct CURVEIK_API FCurveIKCustomVersion
+{
+	enum Type
+	{
+		// Before any version changes were made
+		BeforeCustomVersionWasAdded = 0,
+
+		// FAnimNode_CurveIK::EffectorLocationSpace is honoured. Nodes saved before it always used component space.
+		EffectorLocationSpace,
+
+		// -----<new versions can be added above this line>-------------------------------------------------
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	/** The GUID for this custom version number */
+	const static FGuid GUID;
+
+private:
+	FCurveIKCustomVersion() {}
+};
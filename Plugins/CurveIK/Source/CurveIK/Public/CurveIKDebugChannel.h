@@ -0,0 +1,60 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+#include "CurveIKCore.h"
+
+/** Debug data of one solve, published by the anim worker as an immutable snapshot */
+struct FCurveIKDebugSnapshot
+{
+	FCurveIKDebugData CurveIKDebugData;
+	TArray<FCurveIKChainLink> Chain;
+
+	/** Increases with every published snapshot, so observers can tell when the data changed */
+	uint32 Version = 0;
+};
+
+/**
+ * Hands debug data from the anim worker that evaluates a FAnimNode_CurveIK to editor tools on the game thread.
+ * The worker publishes immutable snapshots and readers hold on to the one they are drawing, so neither side ever
+ * sees a partially written solve. Copies start out empty, so every node instance gets its own channel.
+ */
+class CURVEIK_API FCurveIKDebugChannel
+{
+public:
+	FCurveIKDebugChannel() = default;
+	FCurveIKDebugChannel(const FCurveIKDebugChannel&) {}
+	FCurveIKDebugChannel& operator=(const FCurveIKDebugChannel&) { return *this; }
+
+	/** Set by editor tools while they read from the channel. The node only records debug data while observed. */
+	FThreadSafeBool bObserved;
+
+	/** Publishes a new snapshot if Chain was placed differently from the latest one. Called by the anim worker. */
+	void Publish(const FCurveIKDebugData& CurveIKDebugData, const TArray<FCurveIKChainLink>& Chain);
+
+	/** The latest snapshot, or null if nothing was published yet */
+	TSharedPtr<const FCurveIKDebugSnapshot, ESPMode::ThreadSafe> GetSnapshot() const;
+
+	/** Records the time and outcome of a solve. Called by the anim worker. */
+	void AddSolve(float SolveTimeMs, const FCurveIKSolveResult& Result);
+
+	/**
+	 * Copies the times of recent solves, oldest first, and the outcome of the latest one.
+	 * OutLastResult is left unchanged if no solve was recorded.
+	 */
+	void GetSolves(TArray<float>& OutSolveTimesMs, FCurveIKSolveResult& OutLastResult) const;
+
+	/** Heap memory used by the solve history and the latest snapshot */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	mutable FCriticalSection Lock;
+
+	TSharedPtr<const FCurveIKDebugSnapshot, ESPMode::ThreadSafe> Snapshot;
+
+	/** A ring buffer, oldest entry at SolveTimesIndex once full */
+	TArray<float> SolveTimesMs;
+	int32 SolveTimesIndex = 0;
+
+	FCurveIKSolveResult LastResult;
+};
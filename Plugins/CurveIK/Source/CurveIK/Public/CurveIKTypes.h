@@ -0,0 +1,30 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectMacros.h"
+#include "IKCurves/IKCurve.h"
+#include "CurveIKTypes.generated.h"
+
+UENUM(BlueprintType)
+enum EIKCurveTypes
+{
+	IK_QuadraticBezier UMETA(DisplayName = "Quadratic Bezier"),
+	IK_CubicBezier UMETA(DisplayName = "Cubic Bezier"),
+};
+
+/** Converts the curve type set on the node to the one used by the solver */
+inline ECurveIKCurveType ToSolverCurveType(EIKCurveTypes CurveType)
+{
+	return CurveType == IK_CubicBezier ? ECurveIKCurveType::CubicBezier : ECurveIKCurveType::QuadraticBezier;
+}
+
+/** What a CurveIK node does when the world's CurveIK budget for the frame has run out before it solves */
+UENUM()
+enum class ECurveIKOverBudgetPolicy : uint8
+{
+	/** Solve with the node's cheaper over budget settings */
+	CheaperSettings,
+
+	/** Keep the chain's last solved shape, carried along with its root. Solves with the cheaper settings if there is none. */
+	ReuseLastResult,
+};
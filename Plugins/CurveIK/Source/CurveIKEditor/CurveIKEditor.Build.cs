@@ -13,16 +13,22 @@ public class CurveIKEditor : ModuleRules
 			"CoreUObject",
 			"Engine",
 			"InputCore",
-			"CurveIK"
+			"CurveIK",
+			"CurveIKSolver"
 		});
 
 		PrivateDependencyModuleNames.AddRange(new string[] {
 			"UnrealED",
 			"AnimGraph",
 			"AnimGraphRuntime",
+			"AssetRegistry",
 			"BlueprintGraph",
+			"ContentBrowser",
 			"Persona",
-			"SlateCore"
+			"PropertyEditor",
+			"Slate",
+			"SlateCore",
+			"ToolMenus"
 		});
 	}
 }
@@ -1,14 +1,32 @@
 #include "AnimGraphNode_CurveIK.h"
+#include "Animation/AnimBlueprint.h"
 #include "Animation/AnimInstance.h"
+#include "Animation/Skeleton.h"
 #include "AnimNodeEditModes.h"
 #include "AnimationCustomVersion.h"
 #include "CurveIKEditModes.h"
+#include "CurveIKAutotune.h"
+#include "CanvasItem.h"
+#include "CanvasTypes.h"
+#include "EdGraph/EdGraphSchema.h"
+#include "Engine/Engine.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Misc/ScopedSlowTask.h"
+#include "ScopedTransaction.h"
+#include "ToolMenus.h"
+#include "UnrealClient.h"
+#include "Widgets/Notifications/SNotificationList.h"
+
+#define LOCTEXT_NAMESPACE "AnimGraphNode_CurveIK"
 
 
 const FEditorModeID CurveIKEditModes::CurveIK("UAnimGraphNode_CurveIK.CurveIK");
 
 UAnimGraphNode_CurveIK::UAnimGraphNode_CurveIK(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
+	, AutotuneTipErrorBudget(0.5f)
+	, AutotuneRollErrorBudget(2.f)
 {
 }
 
@@ -28,25 +46,193 @@ void UAnimGraphNode_CurveIK::Draw(FPrimitiveDrawInterface* PDI, USkeletalMeshCom
 	}
 }
 
+void UAnimGraphNode_CurveIK::DrawCanvas(FViewport& InViewport, FSceneView& View, FCanvas& Canvas, USkeletalMeshComponent* PreviewSkelMeshComp) const
+{
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	if (!PreviewSkelMeshComp)
+	{
+		return;
+	}
+
+	const FAnimNode_CurveIK* ActiveNode = GetActiveInstanceNode<FAnimNode_CurveIK>(PreviewSkelMeshComp->GetAnimInstance());
+	if (!ActiveNode)
+	{
+		return;
+	}
+
+	TArray<float> History;
+	FCurveIKSolveResult LastResult;
+	ActiveNode->DebugChannel.GetSolves(History, LastResult);
+	if (History.Num() < 2)
+	{
+		return;
+	}
+
+	// Rolling graph of recent solve times in the bottom left corner of the viewport
+	const FVector2D GraphSize(240.f, 80.f);
+	const FVector2D GraphOrigin(10.f, InViewport.GetSizeXY().Y - GraphSize.Y - 10.f);
+
+	float MaxTimeMs = 0.01f;
+	for (const float TimeMs : History)
+	{
+		MaxTimeMs = FMath::Max(MaxTimeMs, TimeMs);
+	}
+
+	FCanvasBoxItem Box(GraphOrigin, GraphSize);
+	Box.SetColor(FLinearColor::Gray);
+	Canvas.DrawItem(Box);
+
+	const float StepX = GraphSize.X / (History.Num() - 1);
+	FVector2D PrevPoint;
+	for (int32 Sample = 0; Sample < History.Num(); Sample++)
+	{
+		const float TimeMs = History[Sample];
+		const FVector2D Point(GraphOrigin.X + Sample * StepX, GraphOrigin.Y + GraphSize.Y * (1.f - TimeMs / MaxTimeMs));
+		if (Sample > 0)
+		{
+			FCanvasLineItem Line(PrevPoint, Point);
+			Line.SetColor(FLinearColor::Green);
+			Canvas.DrawItem(Line);
+		}
+		PrevPoint = Point;
+	}
+
+	Canvas.DrawShadowedString(GraphOrigin.X + 4.f, GraphOrigin.Y + 2.f, *FString::Printf(TEXT("Solve %.3f ms (max %.3f ms)"), History.Last(), MaxTimeMs), GEngine->GetSmallFont(), FLinearColor::White);
+#endif // #if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+}
+
+void UAnimGraphNode_CurveIK::GetOnScreenDebugInfo(TArray<FText>& DebugInfo, FAnimNode_Base* RuntimeAnimNode, USkeletalMeshComponent* PreviewSkelMeshComp) const
+{
+	if (!RuntimeAnimNode)
+	{
+		return;
+	}
+
+	// The node is evaluated on an anim worker, so only the channel's locked copy of its results is read
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	const FAnimNode_CurveIK* CurveIKNode = static_cast<FAnimNode_CurveIK*>(RuntimeAnimNode);
+	TArray<float> History;
+	FCurveIKSolveResult Result;
+	CurveIKNode->DebugChannel.GetSolves(History, Result);
+	if (History.Num() == 0)
+	{
+		return;
+	}
+
+	float TotalTimeMs = 0.f;
+	float MaxTimeMs = 0.f;
+	for (const float TimeMs : History)
+	{
+		TotalTimeMs += TimeMs;
+		MaxTimeMs = FMath::Max(MaxTimeMs, TimeMs);
+	}
+	DebugInfo.Add(FText::FromString(FString::Printf(TEXT("CurveIK solve: %.3f ms (avg %.3f ms, max %.3f ms)"),
+		History.Last(), TotalTimeMs / History.Num(), MaxTimeMs)));
+
+	DebugInfo.Add(FText::FromString(FString::Printf(TEXT("CurveIK %s: %d / %d iterations, %s"),
+		LexToString(Result.Path), Result.Iterations, CurveIKNode->MaxIterations, Result.bConverged ? TEXT("converged") : TEXT("not converged"))));
+	DebugInfo.Add(FText::FromString(FString::Printf(TEXT("CurveIK cache samples: %d%s, residual: %.4f, tip error: %.4f"),
+		Result.NumCurveSamples, Result.bSharedCacheHit ? TEXT(" (shared cache hit)") : TEXT(""), Result.ArcLengthResidual, Result.TipError)));
+#endif // #if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+}
+
 FText UAnimGraphNode_CurveIK::GetNodeTitle(ENodeTitleType::Type TitleType) const
 {
 	return GetControllerDescription();
 }
 
+void UAnimGraphNode_CurveIK::GetNodeContextMenuActions(UToolMenu* Menu, UGraphNodeContextMenuContext* Context) const
+{
+	Super::GetNodeContextMenuActions(Menu, Context);
+
+	if (Context->bIsDebugging)
+	{
+		return;
+	}
+
+	FToolMenuSection& Section = Menu->AddSection("CurveIK", LOCTEXT("CurveIKHeader", "Curve IK"));
+	Section.AddMenuEntry(
+		"AutotuneSolverSettings",
+		LOCTEXT("AutotuneSolverSettings", "Autotune Solver Settings"),
+		LOCTEXT("AutotuneSolverSettingsTooltip", "Finds the cheapest Curve Detail, Max Iterations and Curve Fit Tolerance that keep the tip and roll errors within the autotune budgets"),
+		FSlateIcon(),
+		FUIAction(FExecuteAction::CreateUObject(const_cast<UAnimGraphNode_CurveIK*>(this), &UAnimGraphNode_CurveIK::AutotuneSolverSettings)));
+}
+
+void UAnimGraphNode_CurveIK::AutotuneSolverSettings()
+{
+	UAnimBlueprint* AnimBlueprint = GetAnimBlueprint();
+	const USkeleton* Skeleton = AnimBlueprint ? AnimBlueprint->TargetSkeleton : nullptr;
+
+	TArray<float> LinkLengths;
+	if (!Skeleton || !CurveIKAutotune::GatherLinkLengths(Skeleton->GetReferenceSkeleton(), Node.RootBone.BoneName, Node.TipBone.BoneName, LinkLengths))
+	{
+		FNotificationInfo Info(LOCTEXT("AutotuneInvalidChain", "Autotune needs a Root Bone that is an ancestor of the Tip Bone"));
+		Info.ExpireDuration = 5.f;
+		FSlateNotificationManager::Get().AddNotification(Info);
+		return;
+	}
+
+	FCurveIKAutotuneResult Result;
+	{
+		FScopedSlowTask SlowTask(0.f, LOCTEXT("AutotuneProgress", "Autotuning Curve IK solver settings..."));
+		SlowTask.MakeDialog();
+		Result = CurveIKAutotune::FindCheapestSettings(LinkLengths, Node, AutotuneTipErrorBudget, AutotuneRollErrorBudget);
+	}
+
+	{
+		const FScopedTransaction Transaction(LOCTEXT("AutotuneTransaction", "Autotune Curve IK"));
+		Modify();
+		Node.CurveDetail = Result.CurveDetail;
+		Node.MaxIterations = Result.MaxIterations;
+		Node.CurveFitTolerance = Result.CurveFitTolerance;
+	}
+	FBlueprintEditorUtils::MarkBlueprintAsModified(AnimBlueprint);
+
+	const FText Message = FText::Format(
+		Result.bWithinBudget
+			? LOCTEXT("AutotuneSucceeded", "Curve IK autotuned to {0} detail, {1} iterations, {2} tolerance: {3} us per solve, tip error {4}, roll error {5} deg")
+			: LOCTEXT("AutotuneOverBudget", "No Curve IK settings met the budgets. Using the most accurate: {0} detail, {1} iterations, {2} tolerance: {3} us per solve, tip error {4}, roll error {5} deg"),
+		FText::AsNumber(Result.CurveDetail), FText::AsNumber(Result.MaxIterations), FText::AsNumber(Result.CurveFitTolerance),
+		FText::AsNumber(Result.SolveTimeMicroseconds), FText::AsNumber(Result.MaxTipError), FText::AsNumber(Result.MaxRollError));
+
+	UE_LOG(LogAnimation, Log, TEXT("%s"), *Message.ToString());
+
+	FNotificationInfo Info(Message);
+	Info.ExpireDuration = 8.f;
+	TSharedPtr<SNotificationItem> Notification = FSlateNotificationManager::Get().AddNotification(Info);
+	if (Notification.IsValid())
+	{
+		Notification->SetCompletionState(Result.bWithinBudget ? SNotificationItem::CS_Success : SNotificationItem::CS_Fail);
+	}
+}
+
 void UAnimGraphNode_CurveIK::CopyNodeDataToPreviewNode(FAnimNode_Base* InPreviewNode)
 {
 	FAnimNode_CurveIK* AnimNodeCurveIK = static_cast<FAnimNode_CurveIK*>(InPreviewNode);
 
 	// copies Pin values from the internal node to get data which are not compiled yet
 	AnimNodeCurveIK->EffectorLocation = Node.EffectorLocation;
+	AnimNodeCurveIK->EffectorLocationSpace = Node.EffectorLocationSpace;
 	AnimNodeCurveIK->Stretch = Node.Stretch;
 	AnimNodeCurveIK->MaxIterations = Node.MaxIterations;
 	AnimNodeCurveIK->CurveDetail = Node.CurveDetail;
+	AnimNodeCurveIK->MaxCurveError = Node.MaxCurveError;
 	AnimNodeCurveIK->CurveFitTolerance = Node.CurveFitTolerance;
 	AnimNodeCurveIK->NormalRotation = Node.NormalRotation;
 	AnimNodeCurveIK->CurveType = Node.CurveType;
 	AnimNodeCurveIK->HandleAngle = Node.HandleAngle;
 	AnimNodeCurveIK->ControlPointWeight = Node.ControlPointWeight;
+	AnimNodeCurveIK->bUseSharedCurveCache = Node.bUseSharedCurveCache;
+	AnimNodeCurveIK->bPrecomputeHandleHeights = Node.bPrecomputeHandleHeights;
+	AnimNodeCurveIK->bAsyncSolve = Node.bAsyncSolve;
+	AnimNodeCurveIK->bAvoidCollisions = Node.bAvoidCollisions;
+	AnimNodeCurveIK->CollisionRadius = Node.CollisionRadius;
+	AnimNodeCurveIK->SetColliders(Node.Colliders, Node.bUsePhysicsAssetColliders);
+	AnimNodeCurveIK->Significance = Node.Significance;
+	AnimNodeCurveIK->OverBudgetPolicy = Node.OverBudgetPolicy;
+	AnimNodeCurveIK->OverBudgetMaxIterations = Node.OverBudgetMaxIterations;
+	AnimNodeCurveIK->OverBudgetCurveDetail = Node.OverBudgetCurveDetail;
 }
 
 FEditorModeID UAnimGraphNode_CurveIK::GetEditorMode() const
@@ -60,3 +246,5 @@ void UAnimGraphNode_CurveIK::Serialize(FArchive& Ar)
 
 	Ar.UsingCustomVersion(FAnimationCustomVersion::GUID);
 }
+
+#undef LOCTEXT_NAMESPACE
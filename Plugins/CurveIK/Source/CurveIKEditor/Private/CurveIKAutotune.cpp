@@ -0,0 +1,210 @@
+#include "CurveIKAutotune.h"
+#include "AnimNode_CurveIK.h"
+#include "CurveIKChainCache.h"
+#include "CurveIKHeightCurve.h"
+#include "HAL/PlatformTime.h"
+
+namespace CurveIKAutotune
+{
+	struct FCandidate
+	{
+		int32 CurveDetail;
+		int32 MaxIterations;
+		float CurveFitTolerance;
+	};
+
+	/** The parameter grid searched by the autotuner */
+	static const int32 CurveDetails[] = { 6, 8, 12, 16, 20, 32, 48, 64 };
+	static const int32 IterationCounts[] = { 5, 10, 15, 20, 30, 50, 100 };
+	static const float Tolerances[] = { 0.5f, 0.1f, 0.05f, 0.01f, 0.001f };
+
+	/** Settings for the high quality solve that roll error is measured against */
+	static const FCandidate ReferenceSettings = { 128, 200, 0.0001f };
+
+	/** Targets are swept over this many directions at each of the reach fractions below */
+	static const int32 NumTargetDirections = 32;
+	static const float TargetReachFractions[] = { 0.25f, 0.5f, 0.75f, 0.95f };
+
+	/** Number of times the target sweep is repeated when timing the chosen settings */
+	static const int32 NumTimingRepeats = 20;
+
+	bool GatherLinkLengths(const FReferenceSkeleton& RefSkeleton, FName RootBone, FName TipBone, TArray<float>& OutLinkLengths)
+	{
+		OutLinkLengths.Reset();
+
+		FCurveIKChainMetadata ChainMetadata;
+		if (!FCurveIKChainMetadata::Build(RefSkeleton, RootBone, TipBone, ChainMetadata))
+		{
+			return false;
+		}
+
+		// Zero length bones follow their parent link, just like in FAnimNode_CurveIK. The root's length is always zero.
+		for (const float Length : ChainMetadata.BoneLengths)
+		{
+			if (!FMath::IsNearlyZero(Length))
+			{
+				OutLinkLengths.Add(Length);
+			}
+		}
+
+		return OutLinkLengths.Num() > 0;
+	}
+
+	/** Solves for the reference, with exact curves and no caches */
+	static void SolveReference(TArray<FCurveIKChainLink>& Chain, const FVector& Target, float MaximumReach, const FAnimNode_CurveIK& Node)
+	{
+		CurveIK_AnimationCore::SolveCurveIK(Chain, Target, Node.ControlPointWeight, MaximumReach,
+		                                    ReferenceSettings.MaxIterations, ReferenceSettings.CurveFitTolerance, ReferenceSettings.CurveDetail,
+		                                    Node.Stretch, nullptr, Node.HandleAngle, ToSolverCurveType(Node.CurveType));
+	}
+
+	/** Solves a candidate the way the node would solve it at runtime */
+	static FCurveIKSolveResult Solve(TArray<FCurveIKChainLink>& Chain, const FVector& Target, float MaximumReach,
+	                                 const FAnimNode_CurveIK& Node, const FCandidate& Settings, const FCurveIKHeightCurve* HeightCurve)
+	{
+		return CurveIK_AnimationCore::SolveCurveIK(Chain, Target, Node.ControlPointWeight, MaximumReach,
+		                                           Settings.MaxIterations, Settings.CurveFitTolerance, Settings.CurveDetail,
+		                                           Node.Stretch, nullptr, Node.HandleAngle, ToSolverCurveType(Node.CurveType),
+		                                           Node.MaxCurveError, Node.bUseSharedCurveCache, nullptr, 0.f, HeightCurve);
+	}
+
+	/** The handle heights the node would fit for a candidate, or null if it does not precompute them */
+	static TUniquePtr<FCurveIKHeightCurve> MakeHeightCurve(float MaximumReach, const FAnimNode_CurveIK& Node, const FCandidate& Settings)
+	{
+		if (!Node.bPrecomputeHandleHeights)
+		{
+			return nullptr;
+		}
+
+		FCurveIKHeightCurve::FSettings HeightCurveSettings;
+		HeightCurveSettings.MaximumReach = MaximumReach;
+		HeightCurveSettings.ControlPointWeight = Node.ControlPointWeight;
+		HeightCurveSettings.MaxIterations = Settings.MaxIterations;
+		HeightCurveSettings.CurveFitTolerance = Settings.CurveFitTolerance;
+		HeightCurveSettings.NumPointsOnCurve = Settings.CurveDetail;
+		HeightCurveSettings.HandleAngle = Node.HandleAngle;
+		HeightCurveSettings.MaxCurveError = Node.MaxCurveError;
+		HeightCurveSettings.CurveType = ToSolverCurveType(Node.CurveType);
+		return MakeUnique<FCurveIKHeightCurve>(HeightCurveSettings);
+	}
+
+	FCurveIKAutotuneResult FindCheapestSettings(const TArray<float>& LinkLengths, const FAnimNode_CurveIK& Node,
+	                                            float TipErrorBudget, float RollErrorBudget)
+	{
+		FCurveIKAutotuneResult Best;
+
+		// Lay the chain out along X from the origin. The solver only reads the root position and link lengths.
+		TArray<FCurveIKChainLink> Chain;
+		float MaximumReach = 0.f;
+		Chain.Add(FCurveIKChainLink(FVector::ZeroVector, 0.f, 0, 0));
+		for (const float Length : LinkLengths)
+		{
+			MaximumReach += Length;
+			Chain.Add(FCurveIKChainLink(FVector(MaximumReach, 0.f, 0.f), Length, Chain.Num(), Chain.Num()));
+		}
+
+		// Fibonacci sphere directions give an even spread of targets over the workspace
+		TArray<FVector> Targets;
+		for (int32 DirectionIndex = 0; DirectionIndex < NumTargetDirections; DirectionIndex++)
+		{
+			const float Z = 1.f - 2.f * (DirectionIndex + 0.5f) / NumTargetDirections;
+			const float Radius = FMath::Sqrt(1.f - Z * Z);
+			const float Azimuth = PI * (3.f - FMath::Sqrt(5.f)) * DirectionIndex;
+			const FVector Direction(Radius * FMath::Cos(Azimuth), Radius * FMath::Sin(Azimuth), Z);
+			for (const float ReachFraction : TargetReachFractions)
+			{
+				Targets.Add(Direction * MaximumReach * ReachFraction);
+			}
+		}
+
+		// Bones are oriented as the node orients them, from the chain's layout along X
+		TArray<TArray<FQuat>> ReferenceRotations;
+		ReferenceRotations.SetNum(Targets.Num());
+		for (int32 TargetIndex = 0; TargetIndex < Targets.Num(); TargetIndex++)
+		{
+			SolveReference(Chain, Targets[TargetIndex], MaximumReach, Node);
+			CurveIK_AnimationCore::GetSolvedBoneRotations(Chain, ReferenceRotations[TargetIndex]);
+		}
+		TArray<FQuat> Rotations;
+
+		int64 BestCost = MAX_int64;
+		float BestOverBudget = MAX_flt;
+		FCandidate BestCandidate = ReferenceSettings;
+
+		// A maximum curve error picks the sample count at runtime, so the node's curve detail is kept as it is
+		TArray<int32, TInlineAllocator<ARRAY_COUNT(CurveDetails)>> CandidateCurveDetails;
+		if (Node.MaxCurveError > 0.f)
+		{
+			CandidateCurveDetails.Add(Node.CurveDetail);
+		}
+		else
+		{
+			CandidateCurveDetails.Append(CurveDetails, ARRAY_COUNT(CurveDetails));
+		}
+
+		for (const int32 CurveDetail : CandidateCurveDetails)
+		{
+			for (const int32 MaxIterations : IterationCounts)
+			{
+				for (const float CurveFitTolerance : Tolerances)
+				{
+					const FCandidate Candidate = { CurveDetail, MaxIterations, CurveFitTolerance };
+					const TUniquePtr<FCurveIKHeightCurve> HeightCurve = MakeHeightCurve(MaximumReach, Node, Candidate);
+					int64 Cost = 0;
+					float MaxTipError = 0.f;
+					float MaxRollError = 0.f;
+
+					for (int32 TargetIndex = 0; TargetIndex < Targets.Num(); TargetIndex++)
+					{
+						const FCurveIKSolveResult Result = Solve(Chain, Targets[TargetIndex], MaximumReach, Node, Candidate, HeightCurve.Get());
+						Cost += Result.NumCurveSamples;
+						MaxTipError = FMath::Max(MaxTipError, Result.TipError);
+
+						CurveIK_AnimationCore::GetSolvedBoneRotations(Chain, Rotations);
+						for (int32 BoneIndex = 0; BoneIndex < Rotations.Num(); BoneIndex++)
+						{
+							const float Roll = CurveIK_AnimationCore::GetBoneRoll(ReferenceRotations[TargetIndex][BoneIndex], Rotations[BoneIndex]);
+							MaxRollError = FMath::Max(MaxRollError, FMath::Abs(Roll));
+						}
+					}
+
+					// Sample count is a stable stand-in for cost; timing every candidate would be too noisy to rank them
+					const bool bWithinBudget = MaxTipError <= TipErrorBudget && MaxRollError <= RollErrorBudget;
+					const float OverBudget = FMath::Max(MaxTipError / FMath::Max(TipErrorBudget, KINDA_SMALL_NUMBER),
+					                                    MaxRollError / FMath::Max(RollErrorBudget, KINDA_SMALL_NUMBER));
+					const bool bBetter = bWithinBudget
+						? (!Best.bWithinBudget || Cost < BestCost)
+						: (!Best.bWithinBudget && OverBudget < BestOverBudget);
+
+					if (bBetter)
+					{
+						Best.bWithinBudget = bWithinBudget;
+						Best.MaxTipError = MaxTipError;
+						Best.MaxRollError = MaxRollError;
+						BestCandidate = Candidate;
+						BestCost = Cost;
+						BestOverBudget = OverBudget;
+					}
+				}
+			}
+		}
+
+		Best.CurveDetail = BestCandidate.CurveDetail;
+		Best.MaxIterations = BestCandidate.MaxIterations;
+		Best.CurveFitTolerance = BestCandidate.CurveFitTolerance;
+
+		const TUniquePtr<FCurveIKHeightCurve> BestHeightCurve = MakeHeightCurve(MaximumReach, Node, BestCandidate);
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Repeat = 0; Repeat < NumTimingRepeats; Repeat++)
+		{
+			for (const FVector& Target : Targets)
+			{
+				Solve(Chain, Target, MaximumReach, Node, BestCandidate, BestHeightCurve.Get());
+			}
+		}
+		const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+		Best.SolveTimeMicroseconds = ElapsedSeconds * 1000000.0 / (NumTimingRepeats * Targets.Num());
+
+		return Best;
+	}
+}
@@ -0,0 +1,241 @@
+#include "CurveIKBake.h"
+#include "AnimNode_CurveIK.h"
+#include "Animation/AnimSequence.h"
+#include "Animation/Skeleton.h"
+#include "AssetRegistryModule.h"
+#include "CurveIKChainCache.h"
+#include "Async/ParallelFor.h"
+#include "BonePose.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCurveIKBake, Log, All);
+
+UCurveIKBakeSettings::UCurveIKBakeSettings()
+	: Suffix(TEXT("_CurveIK"))
+	, ControlPointWeight(0.5f)
+	, CurveType(IK_QuadraticBezier)
+	, MaxIterations(100)
+	, CurveDetail(20)
+	, MaxCurveError(0.f)
+	, CurveFitTolerance(0.01f)
+	, Stretch(0.f)
+	, HandleAngle(0.f)
+{
+}
+
+void UCurveIKBakeSettings::ApplyTo(FAnimNode_CurveIK& Node) const
+{
+	Node.RootBone = FBoneReference(RootBone);
+	Node.TipBone = FBoneReference(TipBone);
+	Node.EffectorTarget = FBoneSocketTarget(EffectorBone);
+	Node.EffectorLocationSpace = BCS_BoneSpace;
+	Node.EffectorLocation = FVector::ZeroVector;
+	Node.ControlPointWeight = ControlPointWeight;
+	Node.CurveType = CurveType;
+	Node.MaxIterations = MaxIterations;
+	Node.CurveDetail = CurveDetail;
+	Node.MaxCurveError = MaxCurveError;
+	Node.CurveFitTolerance = CurveFitTolerance;
+	Node.Stretch = Stretch;
+	Node.HandleAngle = HandleAngle;
+
+	// Every frame must be solved from its own pose
+	Node.bAsyncSolve = false;
+}
+
+namespace CurveIKBake
+{
+	/** A source sequence and the keys solved for it */
+	struct FJob
+	{
+		UAnimSequence* Source = nullptr;
+		TUniquePtr<FBoneContainer> BoneContainer;
+		FAnimNode_CurveIK Node;
+
+		/** Bone names of the chain from root to tip, and the local transform of each bone at every frame */
+		TArray<FName> BoneNames;
+		TArray<FRawAnimSequenceTrack> Tracks;
+
+		/** Long package name of the baked sequence */
+		FString BakedPackageName;
+
+		/** Set once every frame has been solved into Tracks */
+		bool bSolved = false;
+	};
+
+	/**
+	 * Samples every frame of the job's source, solves the chain and records its local transforms. Safe to run on any thread.
+	 * Stops, and leaves bSolved unset, if a frame's solved chain does not match the job's tracks.
+	 */
+	static void SolveJob(FJob& Job)
+	{
+		const FBoneContainer& BoneContainer = *Job.BoneContainer;
+		const int32 NumFrames = Job.Source->GetRawNumberOfFrames();
+		const float SequenceLength = Job.Source->SequenceLength;
+
+		FCompactPose LocalPose;
+		LocalPose.SetBoneContainer(&BoneContainer);
+		FBlendedCurve Curve;
+		Curve.InitFrom(BoneContainer);
+		FCSPose<FCompactPose> ComponentPose;
+		TArray<FBoneTransform> BoneTransforms;
+
+		for (int32 Frame = 0; Frame < NumFrames; Frame++)
+		{
+			const float Time = NumFrames > 1 ? SequenceLength * Frame / (NumFrames - 1) : 0.f;
+			Job.Source->GetBonePose(LocalPose, Curve, FAnimExtractContext(Time), true);
+
+			ComponentPose.InitPose(LocalPose);
+			BoneTransforms.Reset();
+			Job.Node.EvaluateLocalSpace(FTransform::Identity, ComponentPose, BoneTransforms);
+
+			// A node that did not evaluate writes nothing, and keys from another chain would land on the wrong tracks
+			if (BoneTransforms.Num() != Job.Tracks.Num())
+			{
+				UE_LOG(LogCurveIKBake, Error, TEXT("%s: frame %d solved %d bones, expected %d. The sequence is not baked."),
+				       *Job.Source->GetName(), Frame, BoneTransforms.Num(), Job.Tracks.Num());
+				return;
+			}
+
+			for (int32 BoneIndex = 0; BoneIndex < BoneTransforms.Num(); BoneIndex++)
+			{
+				const FTransform& LocalTransform = BoneTransforms[BoneIndex].Transform;
+				FRawAnimSequenceTrack& Track = Job.Tracks[BoneIndex];
+				Track.PosKeys.Add(LocalTransform.GetTranslation());
+				Track.RotKeys.Add(LocalTransform.GetRotation());
+				Track.ScaleKeys.Add(LocalTransform.GetScale3D());
+			}
+		}
+
+		Job.bSolved = true;
+	}
+
+	/** Validates Source against Settings and prepares a job for it. Returns false, and logs why, if it cannot be baked. */
+	static bool InitializeJob(UAnimSequence* Source, const UCurveIKBakeSettings& Settings, FJob& OutJob)
+	{
+		USkeleton* Skeleton = Source ? Source->GetSkeleton() : nullptr;
+		if (!Skeleton)
+		{
+			UE_LOG(LogCurveIKBake, Error, TEXT("%s has no skeleton"), *GetNameSafe(Source));
+			return false;
+		}
+
+		const FReferenceSkeleton& RefSkeleton = Skeleton->GetReferenceSkeleton();
+		FCurveIKChainMetadata ChainMetadata;
+		if (!FCurveIKChainMetadata::Build(RefSkeleton, Settings.RootBone, Settings.TipBone, ChainMetadata)
+			|| RefSkeleton.FindBoneIndex(Settings.EffectorBone) == INDEX_NONE)
+		{
+			UE_LOG(LogCurveIKBake, Error, TEXT("%s: %s must have bones %s and %s, with the tip below the root, and the effector bone %s"),
+			       *Source->GetName(), *Skeleton->GetName(), *Settings.RootBone.ToString(), *Settings.TipBone.ToString(), *Settings.EffectorBone.ToString());
+			return false;
+		}
+
+		// Baking never replaces an asset, which may be referenced or edited by hand
+		const FString BakedPackageName = FPackageName::GetLongPackagePath(Source->GetOutermost()->GetName()) / (Source->GetName() + Settings.Suffix);
+		if (FindPackage(nullptr, *BakedPackageName) || FPackageName::DoesPackageExist(BakedPackageName))
+		{
+			UE_LOG(LogCurveIKBake, Error, TEXT("%s: %s already exists. Delete or rename it, or change the suffix, to bake again."),
+			       *Source->GetName(), *BakedPackageName);
+			return false;
+		}
+
+		TArray<FBoneIndexType> RequiredBones;
+		RequiredBones.SetNumUninitialized(RefSkeleton.GetNum());
+		for (int32 BoneIndex = 0; BoneIndex < RequiredBones.Num(); BoneIndex++)
+		{
+			RequiredBones[BoneIndex] = BoneIndex;
+		}
+
+		OutJob.Source = Source;
+		OutJob.BakedPackageName = BakedPackageName;
+		OutJob.BoneContainer = MakeUnique<FBoneContainer>(RequiredBones, FCurveEvaluationOption(false), *Skeleton);
+		Settings.ApplyTo(OutJob.Node);
+		OutJob.Node.InitializeBones(*OutJob.BoneContainer);
+		OutJob.BoneNames = MoveTemp(ChainMetadata.BoneNames);
+
+		const int32 NumFrames = Source->GetRawNumberOfFrames();
+		OutJob.Tracks.SetNum(OutJob.BoneNames.Num());
+		for (FRawAnimSequenceTrack& Track : OutJob.Tracks)
+		{
+			Track.PosKeys.Reserve(NumFrames);
+			Track.RotKeys.Reserve(NumFrames);
+			Track.ScaleKeys.Reserve(NumFrames);
+		}
+
+		return true;
+	}
+
+	/** Saves a copy of the job's source next to it with the solved chain tracks. Game thread only. */
+	static UAnimSequence* CreateBakedSequence(FJob& Job)
+	{
+		// Another job, or anything else on the game thread, may have taken the name since the job was validated
+		if (FindPackage(nullptr, *Job.BakedPackageName))
+		{
+			UE_LOG(LogCurveIKBake, Error, TEXT("%s: %s already exists. The sequence is not baked."), *Job.Source->GetName(), *Job.BakedPackageName);
+			return nullptr;
+		}
+
+		UPackage* Package = CreatePackage(nullptr, *Job.BakedPackageName);
+		UAnimSequence* Baked = DuplicateObject<UAnimSequence>(Job.Source, Package, *FPackageName::GetShortName(Job.BakedPackageName));
+		if (!Baked)
+		{
+			return nullptr;
+		}
+
+		Baked->Modify();
+		for (int32 BoneIndex = 0; BoneIndex < Job.BoneNames.Num(); BoneIndex++)
+		{
+			Baked->AddNewRawTrack(Job.BoneNames[BoneIndex], &Job.Tracks[BoneIndex]);
+		}
+		Baked->MarkRawDataAsModified();
+		Baked->OnRawDataChanged();
+		Baked->MarkPackageDirty();
+		FAssetRegistryModule::AssetCreated(Baked);
+
+		return Baked;
+	}
+
+	int32 BakeSequences(const TArray<UAnimSequence*>& Sources, const UCurveIKBakeSettings& Settings, TArray<UAnimSequence*>& OutBaked)
+	{
+		check(IsInGameThread());
+
+		OutBaked.Reset();
+		OutBaked.AddZeroed(Sources.Num());
+
+		TArray<FJob> Jobs;
+		Jobs.SetNum(Sources.Num());
+		TArray<int32> ValidJobs;
+		for (int32 SourceIndex = 0; SourceIndex < Sources.Num(); SourceIndex++)
+		{
+			if (InitializeJob(Sources[SourceIndex], Settings, Jobs[SourceIndex]))
+			{
+				ValidJobs.Add(SourceIndex);
+			}
+		}
+
+		// Each job has its own node and pose, and only reads its source, so sequences are solved independently
+		ParallelFor(ValidJobs.Num(), [&Jobs, &ValidJobs](int32 Index)
+		{
+			SolveJob(Jobs[ValidJobs[Index]]);
+		});
+
+		int32 NumBaked = 0;
+		for (const int32 SourceIndex : ValidJobs)
+		{
+			if (!Jobs[SourceIndex].bSolved)
+			{
+				continue;
+			}
+
+			OutBaked[SourceIndex] = CreateBakedSequence(Jobs[SourceIndex]);
+			if (OutBaked[SourceIndex])
+			{
+				UE_LOG(LogCurveIKBake, Display, TEXT("Baked %s into %s"), *Sources[SourceIndex]->GetPathName(), *OutBaked[SourceIndex]->GetPathName());
+				NumBaked++;
+			}
+		}
+
+		return NumBaked;
+	}
+}
@@ -0,0 +1,98 @@
+#include "CurveIKBakeCommandlet.h"
+#include "CurveIKBake.h"
+#include "Animation/AnimSequence.h"
+#include "AssetRegistryModule.h"
+#include "Misc/PackageName.h"
+#include "Misc/Parse.h"
+#include "UObject/Package.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCurveIKBakeCommandlet, Log, All);
+
+UCurveIKBakeCommandlet::UCurveIKBakeCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UCurveIKBakeCommandlet::Main(const FString& Params)
+{
+	UCurveIKBakeSettings* Settings = DuplicateObject(GetDefault<UCurveIKBakeSettings>(), GetTransientPackage());
+	FParse::Value(*Params, TEXT("Root="), Settings->RootBone);
+	FParse::Value(*Params, TEXT("Tip="), Settings->TipBone);
+	FParse::Value(*Params, TEXT("Effector="), Settings->EffectorBone);
+	FParse::Value(*Params, TEXT("Suffix="), Settings->Suffix);
+	FParse::Value(*Params, TEXT("MaxIterations="), Settings->MaxIterations);
+	FParse::Value(*Params, TEXT("CurveDetail="), Settings->CurveDetail);
+	FParse::Value(*Params, TEXT("CurveFitTolerance="), Settings->CurveFitTolerance);
+
+	TArray<FString> PackageNames;
+	FString SequencesParam;
+	if (FParse::Value(*Params, TEXT("Sequences="), SequencesParam, false))
+	{
+		SequencesParam.ParseIntoArray(PackageNames, TEXT(","));
+	}
+
+	FString Path;
+	if (FParse::Value(*Params, TEXT("Path="), Path))
+	{
+		IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+		AssetRegistry.SearchAllAssets(true);
+
+		TArray<FAssetData> Assets;
+		AssetRegistry.GetAssetsByPath(*Path, Assets, true);
+		for (const FAssetData& Asset : Assets)
+		{
+			// Skip the output of earlier bakes
+			if (Asset.AssetClass == UAnimSequence::StaticClass()->GetFName() && !Asset.AssetName.ToString().EndsWith(Settings->Suffix))
+			{
+				PackageNames.Add(Asset.PackageName.ToString());
+			}
+		}
+	}
+
+	TArray<UAnimSequence*> Sources;
+	for (const FString& PackageName : PackageNames)
+	{
+		const FString ObjectPath = PackageName + TEXT(".") + FPackageName::GetShortName(PackageName);
+		if (UAnimSequence* Sequence = LoadObject<UAnimSequence>(nullptr, *ObjectPath))
+		{
+			Sources.Add(Sequence);
+		}
+		else
+		{
+			UE_LOG(LogCurveIKBakeCommandlet, Error, TEXT("Failed to load animation sequence %s"), *PackageName);
+		}
+	}
+
+	if (Sources.Num() == 0)
+	{
+		UE_LOG(LogCurveIKBakeCommandlet, Error, TEXT("No sequences to bake. Pass -Sequences=A,B,... or -Path=/Game/Dir"));
+		return 1;
+	}
+
+	TArray<UAnimSequence*> Baked;
+	const int32 NumBaked = CurveIKBake::BakeSequences(Sources, *Settings, Baked);
+
+	int32 NumSaveFailures = 0;
+	for (UAnimSequence* Sequence : Baked)
+	{
+		if (!Sequence)
+		{
+			continue;
+		}
+
+		UPackage* Package = Sequence->GetOutermost();
+		const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+		if (!UPackage::SavePackage(Package, Sequence, RF_Public | RF_Standalone, *Filename))
+		{
+			UE_LOG(LogCurveIKBakeCommandlet, Error, TEXT("Failed to save %s"), *Filename);
+			NumSaveFailures++;
+		}
+	}
+
+	UE_LOG(LogCurveIKBakeCommandlet, Display, TEXT("Baked %d of %d sequences"), NumBaked, Sources.Num());
+	return NumBaked == Sources.Num() && NumSaveFailures == 0 ? 0 : 1;
+}
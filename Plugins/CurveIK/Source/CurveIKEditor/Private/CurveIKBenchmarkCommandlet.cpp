@@ -0,0 +1,174 @@
+#include "CurveIKBenchmarkCommandlet.h"
+#include "CurveIKBatch.h"
+#include "CurveIKCore.h"
+#include "CurveIKTestChains.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCurveIKBenchmark, Log, All);
+
+namespace CurveIKBenchmark
+{
+	struct FPreset
+	{
+		const TCHAR* Name;
+		int32 MaxIterations;
+		int32 CurveDetail;
+		float CurveFitTolerance;
+	};
+
+	/** Solver parameter sets to measure. Default matches the FAnimNode_CurveIK defaults. */
+	static const FPreset Presets[] =
+	{
+		{ TEXT("Fast"), 10, 10, 0.1f },
+		{ TEXT("Default"), 100, 20, 0.01f },
+		{ TEXT("Precise"), 200, 64, 0.001f },
+	};
+
+	static const ECurveIKCurveType CurveTypes[] = { ECurveIKCurveType::QuadraticBezier, ECurveIKCurveType::CubicBezier };
+
+	/** Node settings that are not part of a preset */
+	static const float ControlPointWeight = 0.5f;
+	static const float HandleAngle = 0.f;
+	static const float Stretch = 0.f;
+
+	/** Builds a chain of 2-32 links at a random root, with a target anywhere from 10% to 130% of its reach */
+	static FCurveIKTestChain MakeRandomChain(FRandomStream& Random)
+	{
+		const FVector Root = Random.GetUnitVector() * Random.FRandRange(0.f, 500.f);
+		FCurveIKTestChain Chain = CurveIK_AnimationCore::MakeRandomChain(Random, Root, 2, 32, 2.f, 20.f);
+		Chain.Target = CurveIK_AnimationCore::GetRandomTarget(Random, Chain, 0.1f, 1.3f);
+		return Chain;
+	}
+}
+
+UCurveIKBenchmarkCommandlet::UCurveIKBenchmarkCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UCurveIKBenchmarkCommandlet::Main(const FString& Params)
+{
+	using namespace CurveIKBenchmark;
+
+	int32 Seed = 0;
+	int32 NumChains = 256;
+	int32 NumRepeats = 20;
+	FString OutputPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("CurveIK"), TEXT("Benchmark.csv"));
+
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("Chains="), NumChains);
+	FParse::Value(*Params, TEXT("Repeats="), NumRepeats);
+	FParse::Value(*Params, TEXT("Out="), OutputPath);
+	NumChains = FMath::Max(NumChains, 1);
+	NumRepeats = FMath::Max(NumRepeats, 1);
+
+	FRandomStream Random(Seed);
+	TArray<FCurveIKTestChain> Chains;
+	Chains.Reserve(NumChains);
+	for (int32 ChainIndex = 0; ChainIndex < NumChains; ChainIndex++)
+	{
+		Chains.Add(MakeRandomChain(Random));
+	}
+
+	TArray<FCurveIKBatchChain> BatchChains;
+	BatchChains.SetNum(Chains.Num());
+	for (int32 ChainIndex = 0; ChainIndex < Chains.Num(); ChainIndex++)
+	{
+		BatchChains[ChainIndex].Chain = &Chains[ChainIndex].Links;
+		BatchChains[ChainIndex].TargetLocation = Chains[ChainIndex].Target;
+		BatchChains[ChainIndex].MaximumReach = Chains[ChainIndex].MaximumReach;
+	}
+
+	TArray<FCurveIKSolveResult> Results;
+	Results.SetNum(Chains.Num());
+
+	TArray<FString> Rows;
+	Rows.Add(TEXT("curve_type,preset,backend,max_iterations,curve_detail,curve_fit_tolerance,solves,solves_per_second,mean_iterations,max_iterations_used,non_converged,mean_tip_error,max_tip_error"));
+	UE_LOG(LogCurveIKBenchmark, Display, TEXT("%s"), *Rows.Last());
+
+	for (const ECurveIKCurveType CurveType : CurveTypes)
+	{
+		for (const FPreset& Preset : Presets)
+		{
+			FCurveIKBatchSettings BatchSettings;
+			BatchSettings.ControlPointWeight = ControlPointWeight;
+			BatchSettings.MaxIterations = Preset.MaxIterations;
+			BatchSettings.CurveFitTolerance = Preset.CurveFitTolerance;
+			BatchSettings.NumPointsOnCurve = Preset.CurveDetail;
+			BatchSettings.Stretch = Stretch;
+			BatchSettings.HandleAngle = HandleAngle;
+			BatchSettings.CurveType = CurveType;
+
+			// Solving only reads the root position and link lengths, so the chains can be solved again in place without being reset
+			for (const bool bBatch : { false, true })
+			{
+				auto SolveAll = [&]()
+				{
+					if (bBatch)
+					{
+						CurveIK_AnimationCore::SolveCurveIKBatch(BatchChains, BatchSettings, Results);
+						return;
+					}
+
+					for (int32 ChainIndex = 0; ChainIndex < Chains.Num(); ChainIndex++)
+					{
+						FCurveIKTestChain& Chain = Chains[ChainIndex];
+						Results[ChainIndex] = CurveIK_AnimationCore::SolveCurveIK(
+							Chain.Links, Chain.Target, ControlPointWeight, Chain.MaximumReach, Preset.MaxIterations,
+							Preset.CurveFitTolerance, Preset.CurveDetail, Stretch, nullptr, HandleAngle, CurveType);
+					}
+				};
+
+				// Untimed pass to gather iteration counts and accuracy
+				SolveAll();
+
+				int64 TotalIterations = 0;
+				int32 MaxIterationsUsed = 0;
+				int32 NumNonConverged = 0;
+				double TotalTipError = 0.0;
+				float MaxTipError = 0.f;
+				for (const FCurveIKSolveResult& Result : Results)
+				{
+					TotalIterations += Result.Iterations;
+					MaxIterationsUsed = FMath::Max(MaxIterationsUsed, Result.Iterations);
+					NumNonConverged += Result.bConverged ? 0 : 1;
+					TotalTipError += Result.TipError;
+					MaxTipError = FMath::Max(MaxTipError, Result.TipError);
+				}
+
+				const double StartTime = FPlatformTime::Seconds();
+				for (int32 Repeat = 0; Repeat < NumRepeats; Repeat++)
+				{
+					SolveAll();
+				}
+				const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+				const int32 NumSolves = NumRepeats * Chains.Num();
+
+				Rows.Add(FString::Printf(TEXT("%s,%s,%s,%d,%d,%g,%d,%.1f,%.2f,%d,%d,%.4f,%.4f"),
+				                         LexToString(CurveType), Preset.Name, bBatch ? TEXT("Batch") : TEXT("Scalar"),
+				                         Preset.MaxIterations, Preset.CurveDetail, Preset.CurveFitTolerance, NumSolves,
+				                         NumSolves / FMath::Max(ElapsedSeconds, double(SMALL_NUMBER)),
+				                         double(TotalIterations) / Chains.Num(), MaxIterationsUsed, NumNonConverged,
+				                         TotalTipError / Chains.Num(), MaxTipError));
+				UE_LOG(LogCurveIKBenchmark, Display, TEXT("%s"), *Rows.Last());
+			}
+		}
+	}
+
+	if (!FFileHelper::SaveStringArrayToFile(Rows, *OutputPath))
+	{
+		UE_LOG(LogCurveIKBenchmark, Error, TEXT("Failed to write benchmark results to %s"), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogCurveIKBenchmark, Display, TEXT("Wrote benchmark results to %s"), *OutputPath);
+	return 0;
+}
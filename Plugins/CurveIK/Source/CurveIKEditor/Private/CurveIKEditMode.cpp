@@ -11,12 +11,22 @@ void FCurveIKEditMode::EnterMode(class UAnimGraphNode_Base* InEditorNode, struct
 {
 	RuntimeNode = static_cast<FAnimNode_CurveIK*>(InRuntimeNode);
 	GraphNode = CastChecked<UAnimGraphNode_CurveIK>(InEditorNode);
+	bDebugGeometryValid = false;
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	RuntimeNode->DebugChannel.bObserved = true;
+#endif
 
 	CurveIKEditModeBase::EnterMode(InEditorNode, InRuntimeNode);
 }
 
 void FCurveIKEditMode::ExitMode()
 {
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	if (RuntimeNode)
+	{
+		RuntimeNode->DebugChannel.bObserved = false;
+	}
+#endif
 	RuntimeNode = nullptr;
 	GraphNode = nullptr;
 
@@ -27,10 +37,10 @@ FVector FCurveIKEditMode::GetWidgetLocation() const
 {
 	EBoneControlSpace Space = RuntimeNode->EffectorLocationSpace;
 	FVector Location = RuntimeNode->EffectorLocation;
-	FBoneSocketTarget Target = RuntimeNode->EffectorTarget;
+	const FBoneSocketTarget& Target = RuntimeNode->EffectorTarget;
 
 	USkeletalMeshComponent* SkelComp = GetAnimPreviewScene().GetPreviewMeshComponent();
-	return Location;
+	return ConvertWidgetLocation(SkelComp, RuntimeNode->ForwardedPose, Target, Location, Space);
 }
 
 FWidget::EWidgetMode FCurveIKEditMode::GetWidgetMode() const
@@ -60,129 +70,119 @@ void FCurveIKEditMode::DoTranslation(FVector& InTranslation)
 void FCurveIKEditMode::Render(const FSceneView* View, FViewport* Viewport, FPrimitiveDrawInterface* PDI)
 {
 #if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
-	// draw line from root bone to tip bone if available
 	if (RuntimeNode && RuntimeNode->bEnableDebugDraw)
 	{
-		USkeletalMeshComponent* SkelComp = GetAnimPreviewScene().GetPreviewMeshComponent();
-		FTransform CompToWorld = SkelComp->GetComponentToWorld();
-		FCurveIKDebugData CurveIKDebugData = RuntimeNode->CurveIKDebugData;
-		const FVector MidPoint = CurveIKDebugData.P1 + (CurveIKDebugData.P2 / 2.0);
-		const FVector P1 = CurveIKDebugData.P1;
-		const FVector P2 = CurveIKDebugData.P2;
-		const float LineScale = 200;
-
-		// P Vector
-		PDI->DrawLine(
-			P1,
-			P2,
-			FLinearColor::FromSRGBColor(FColor::Cyan),
-			SDPG_Foreground
-		);
-		PDI->DrawPoint(P1, FColor::Cyan, 15, SDPG_Foreground);
-		PDI->DrawPoint(P2, FColor::Cyan, 15, SDPG_Foreground);
-
-		PDI->DrawLine(
-			MidPoint,
-			MidPoint + (CurveIKDebugData.HandleDir * LineScale),
-			FLinearColor::FromSRGBColor(FColor::Magenta),
-			SDPG_Foreground
-		);
-
-		if (CurveIKDebugData.ControlPoints.Num() >= 3)
+		const TSharedPtr<const FCurveIKDebugSnapshot, ESPMode::ThreadSafe> Snapshot = RuntimeNode->DebugChannel.GetSnapshot();
+		if (!Snapshot.IsValid())
+		{
+			return;
+		}
+
+		const uint8 DebugDrawFlags = GetDebugDrawFlags();
+		if (!bDebugGeometryValid || CachedDebugDataVersion != Snapshot->Version || CachedDebugDrawFlags != DebugDrawFlags)
 		{
-			FVector HandleEnd1 = CurveIKDebugData.ControlPoints[1];
-			// Toggle between quadratic and cubic bezier
-			FVector HandleEnd2 = CurveIKDebugData.ControlPoints[CurveIKDebugData.ControlPoints.Num() == 4 ? 2 : 1];
-			PDI->DrawLine(
-				P1,
-				HandleEnd1,
-				FLinearColor::FromSRGBColor(FColor::Red),
-				SDPG_Foreground
-			);
-			PDI->DrawPoint(HandleEnd1, FLinearColor::FromSRGBColor(FColor::Red), 10, SDPG_Foreground);
-			
-			PDI->DrawLine(
-				P2,
-				HandleEnd2,
-				FLinearColor::FromSRGBColor(FColor::Red),
-				SDPG_Foreground
-			);
-			PDI->DrawPoint(HandleEnd2, FLinearColor::FromSRGBColor(FColor::Red), 10, SDPG_Foreground);
+			RebuildDebugGeometry(*Snapshot);
+			CachedDebugDataVersion = Snapshot->Version;
+			CachedDebugDrawFlags = DebugDrawFlags;
+			bDebugGeometryValid = true;
 		}
 
-		PDI->DrawLine(
-			MidPoint,
-			MidPoint + (CurveIKDebugData.RightVector * LineScale),
-			FLinearColor::FromSRGBColor(FColor::Green),
-			SDPG_Foreground
-		);
-
-		PDI->DrawLine(
-			MidPoint,
-			MidPoint + (CurveIKDebugData.UpVector * LineScale),
-			FLinearColor::FromSRGBColor(FColor::Blue),
-			SDPG_Foreground
-		);
-	
-		for (int i = 1; i < RuntimeNode->Chain.Num(); i++)
+		PDI->AddReserveLines(SDPG_Foreground, DebugLines.Num());
+		for (const FDebugLine& Line : DebugLines)
 		{
-			FCurveIKChainLink ChainLink = RuntimeNode->Chain[i];
-			FCurveIKChainLink LastChainLink = RuntimeNode->Chain[i - 1];
-			if (RuntimeNode->bShowLinks)
-			{				
-				PDI->DrawLine(
-					LastChainLink.Position,
-					ChainLink.Position,
-					FLinearColor::FromSRGBColor(FColor::Orange),
-					SDPG_Foreground
-				);
-				PDI->DrawPoint(ChainLink.Position, FLinearColor::FromSRGBColor(FColor::Orange), 30, SDPG_Foreground);
-			}
-			if (RuntimeNode->bShowTangents)
-			{
-				PDI->DrawLine(
-					ChainLink.Position,
-					ChainLink.Position + (ChainLink.CurvePoint.Tangent * 200.f),
-					FLinearColor::FromSRGBColor(FColor::Emerald),
-					SDPG_Foreground
-				);
-			}
-			if (RuntimeNode->bShowNormals)
-			{				
-				PDI->DrawLine(
-					ChainLink.Position,
-					ChainLink.Position + (ChainLink.CurvePoint.Normal * 200.f),
-					FLinearColor::FromSRGBColor(FColor::Red),
-					SDPG_Foreground
-				);
-			}
-			if (RuntimeNode->bShowBoneDirection)
-			{				
-				PDI->DrawLine(
-					ChainLink.Position,
-					ChainLink.Position + (ChainLink.BoneDownVector * 200.f),
-					FLinearColor::FromSRGBColor(FColor::Yellow),
-					SDPG_Foreground
-				);
-			}
+			PDI->DrawLine(Line.Start, Line.End, Line.Color, SDPG_Foreground);
 		}
 
-		auto CachePoints = CurveIKDebugData.CurveCache.GetPoints();
-		for(int i = 0; i < CachePoints.Num(); i++)
+		for (const FDebugPoint& Point : DebugPoints)
 		{
-			auto Point = CachePoints[i];
-			PDI->DrawPoint(Point, FLinearColor::FromSRGBColor(FColor::Purple), 10, SDPG_Foreground);
-			if(i > 0)
-			{
-				auto PrevPoint = CachePoints[i - 1];
-				PDI->DrawLine(
-					PrevPoint,
-					Point,
-					FLinearColor::FromSRGBColor(FColor::Purple),
-					SDPG_Foreground
-				);
-			}
+			PDI->DrawPoint(Point.Position, Point.Color, Point.Size, SDPG_Foreground);
 		}
 	}
 #endif // #if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
-}
\ No newline at end of file
+}
+
+uint8 FCurveIKEditMode::GetDebugDrawFlags() const
+{
+	uint8 Flags = 0;
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	Flags |= RuntimeNode->bShowLinks ? 1 << 0 : 0;
+	Flags |= RuntimeNode->bShowTangents ? 1 << 1 : 0;
+	Flags |= RuntimeNode->bShowNormals ? 1 << 2 : 0;
+	Flags |= RuntimeNode->bShowBoneDirection ? 1 << 3 : 0;
+#endif
+	return Flags;
+}
+
+void FCurveIKEditMode::RebuildDebugGeometry(const FCurveIKDebugSnapshot& Snapshot)
+{
+	DebugLines.Reset();
+	DebugPoints.Reset();
+
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	const FCurveIKDebugData& CurveIKDebugData = Snapshot.CurveIKDebugData;
+	const TArray<FCurveIKChainLink>& Chain = Snapshot.Chain;
+	const FVector P1 = CurveIKDebugData.P1;
+	const FVector P2 = CurveIKDebugData.P2;
+	const FVector MidPoint = (P1 + P2) / 2.0;
+	const float LineScale = 200;
+
+	const FLinearColor Cyan = FLinearColor::FromSRGBColor(FColor::Cyan);
+	const FLinearColor Red = FLinearColor::FromSRGBColor(FColor::Red);
+	const FLinearColor Orange = FLinearColor::FromSRGBColor(FColor::Orange);
+	const FLinearColor Purple = FLinearColor::FromSRGBColor(FColor::Purple);
+
+	// P Vector
+	DebugLines.Add({ P1, P2, Cyan });
+	DebugPoints.Add({ P1, Cyan, 15 });
+	DebugPoints.Add({ P2, Cyan, 15 });
+
+	DebugLines.Add({ MidPoint, MidPoint + (CurveIKDebugData.HandleDir * LineScale), FLinearColor::FromSRGBColor(FColor::Magenta) });
+
+	if (CurveIKDebugData.ControlPoints.Num() >= 3)
+	{
+		const FVector HandleEnd1 = CurveIKDebugData.ControlPoints[1];
+		// Toggle between quadratic and cubic bezier
+		const FVector HandleEnd2 = CurveIKDebugData.ControlPoints[CurveIKDebugData.ControlPoints.Num() == 4 ? 2 : 1];
+		DebugLines.Add({ P1, HandleEnd1, Red });
+		DebugPoints.Add({ HandleEnd1, Red, 10 });
+		DebugLines.Add({ P2, HandleEnd2, Red });
+		DebugPoints.Add({ HandleEnd2, Red, 10 });
+	}
+
+	DebugLines.Add({ MidPoint, MidPoint + (CurveIKDebugData.RightVector * LineScale), FLinearColor::FromSRGBColor(FColor::Green) });
+	DebugLines.Add({ MidPoint, MidPoint + (CurveIKDebugData.UpVector * LineScale), FLinearColor::FromSRGBColor(FColor::Blue) });
+
+	for (int i = 1; i < Chain.Num(); i++)
+	{
+		const FCurveIKChainLink& ChainLink = Chain[i];
+		const FCurveIKChainLink& LastChainLink = Chain[i - 1];
+		if (RuntimeNode->bShowLinks)
+		{
+			DebugLines.Add({ LastChainLink.Position, ChainLink.Position, Orange });
+			DebugPoints.Add({ ChainLink.Position, Orange, 30 });
+		}
+		if (RuntimeNode->bShowTangents)
+		{
+			DebugLines.Add({ ChainLink.Position, ChainLink.Position + (ChainLink.CurvePoint.Tangent * 200.f), FLinearColor::FromSRGBColor(FColor::Emerald) });
+		}
+		if (RuntimeNode->bShowNormals)
+		{
+			DebugLines.Add({ ChainLink.Position, ChainLink.Position + (ChainLink.CurvePoint.Normal * 200.f), Red });
+		}
+		if (RuntimeNode->bShowBoneDirection)
+		{
+			DebugLines.Add({ ChainLink.Position, ChainLink.Position + (ChainLink.BoneDownVector * 200.f), FLinearColor::FromSRGBColor(FColor::Yellow) });
+		}
+	}
+
+	const TArray<FCurvePoint>& CachePoints = CurveIKDebugData.CurveCache.GetCurvePoints();
+	for (int i = 0; i < CachePoints.Num(); i++)
+	{
+		DebugPoints.Add({ CachePoints[i].Point, Purple, 10 });
+		if (i > 0)
+		{
+			DebugLines.Add({ CachePoints[i - 1].Point, CachePoints[i].Point, Purple });
+		}
+	}
+#endif // #if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+}
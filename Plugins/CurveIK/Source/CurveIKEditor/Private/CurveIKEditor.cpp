@@ -3,8 +3,22 @@
 #include "Modules/ModuleManager.h"
 #include "Modules/ModuleInterface.h"
 #include "Textures/SlateIcon.h"
+#include "CurveIKBake.h"
 #include "CurveIKEditMode.h"
 #include "CurveIKEditModes.h"
+#include "Animation/AnimSequence.h"
+#include "ContentBrowserMenuContexts.h"
+#include "Editor.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "IDetailsView.h"
+#include "Misc/ScopedSlowTask.h"
+#include "PropertyEditorModule.h"
+#include "ToolMenus.h"
+#include "Widgets/Input/SButton.h"
+#include "Widgets/Layout/SUniformGridPanel.h"
+#include "Widgets/Notifications/SNotificationList.h"
+#include "Widgets/SBoxPanel.h"
+#include "Widgets/SWindow.h"
 
 
 #define LOCTEXT_NAMESPACE "FCurveIKEditorModule"
@@ -12,13 +26,136 @@
 void FCurveIKEditorModule::StartupModule()
 {
 	FEditorModeRegistry::Get().RegisterMode<FCurveIKEditMode>(CurveIKEditModes::CurveIK, FText::FromString("CurveIKEditor"), FSlateIcon(), false);
+	UToolMenus::RegisterStartupCallback(FSimpleMulticastDelegate::FDelegate::CreateRaw(this, &FCurveIKEditorModule::RegisterMenus));
 }
 
 void FCurveIKEditorModule::ShutdownModule()
 {
+	UToolMenus::UnRegisterStartupCallback(this);
+	UToolMenus::UnregisterOwner(this);
 	FEditorModeRegistry::Get().UnregisterMode(CurveIKEditModes::CurveIK);
 }
 
+void FCurveIKEditorModule::RegisterMenus()
+{
+	FToolMenuOwnerScoped OwnerScoped(this);
+
+	UToolMenu* Menu = UToolMenus::Get()->ExtendMenu("ContentBrowser.AssetContextMenu.AnimSequence");
+	FToolMenuSection& Section = Menu->FindOrAddSection("GetAssetActions");
+	Section.AddDynamicEntry("CurveIKBake", FNewToolMenuSectionDelegate::CreateLambda([](FToolMenuSection& InSection)
+	{
+		const UContentBrowserAssetContextMenuContext* Context = InSection.FindContext<UContentBrowserAssetContextMenuContext>();
+		if (!Context)
+		{
+			return;
+		}
+
+		TArray<UAnimSequence*> Sequences;
+		for (const TWeakObjectPtr<UObject>& Object : Context->SelectedObjects)
+		{
+			if (UAnimSequence* Sequence = Cast<UAnimSequence>(Object.Get()))
+			{
+				Sequences.Add(Sequence);
+			}
+		}
+
+		InSection.AddMenuEntry(
+			"CurveIKBake",
+			LOCTEXT("CurveIKBake", "Bake CurveIK"),
+			LOCTEXT("CurveIKBakeTooltip", "Solves CurveIK on every frame, following an effector bone, and saves the result as new sequences"),
+			FSlateIcon(),
+			FUIAction(FExecuteAction::CreateStatic(&FCurveIKEditorModule::BakeSequences, Sequences)));
+	}));
+}
+
+void FCurveIKEditorModule::BakeSequences(TArray<UAnimSequence*> Sequences)
+{
+	// Edit a copy, so cancelling leaves the remembered settings alone
+	UCurveIKBakeSettings* Settings = DuplicateObject(GetDefault<UCurveIKBakeSettings>(), GetTransientPackage());
+	Settings->AddToRoot();
+
+	FPropertyEditorModule& PropertyEditorModule = FModuleManager::LoadModuleChecked<FPropertyEditorModule>("PropertyEditor");
+	FDetailsViewArgs DetailsViewArgs;
+	DetailsViewArgs.bAllowSearch = false;
+	DetailsViewArgs.NameAreaSettings = FDetailsViewArgs::HideNameArea;
+	TSharedRef<IDetailsView> DetailsView = PropertyEditorModule.CreateDetailView(DetailsViewArgs);
+	DetailsView->SetObject(Settings);
+
+	bool bBake = false;
+	TSharedRef<SWindow> Window = SNew(SWindow)
+		.Title(LOCTEXT("CurveIKBakeTitle", "Bake CurveIK"))
+		.ClientSize(FVector2D(400.f, 480.f))
+		.SupportsMinimize(false)
+		.SupportsMaximize(false);
+	TWeakPtr<SWindow> WeakWindow = Window;
+
+	Window->SetContent(
+		SNew(SVerticalBox)
+		+ SVerticalBox::Slot()
+		.FillHeight(1.f)
+		[
+			DetailsView
+		]
+		+ SVerticalBox::Slot()
+		.AutoHeight()
+		.HAlign(HAlign_Right)
+		.Padding(4.f)
+		[
+			SNew(SUniformGridPanel)
+			.SlotPadding(2.f)
+			+ SUniformGridPanel::Slot(0, 0)
+			[
+				SNew(SButton)
+				.Text(LOCTEXT("CurveIKBakeConfirm", "Bake"))
+				.OnClicked_Lambda([&bBake, WeakWindow]()
+				{
+					bBake = true;
+					WeakWindow.Pin()->RequestDestroyWindow();
+					return FReply::Handled();
+				})
+			]
+			+ SUniformGridPanel::Slot(1, 0)
+			[
+				SNew(SButton)
+				.Text(LOCTEXT("CurveIKBakeCancel", "Cancel"))
+				.OnClicked_Lambda([WeakWindow]()
+				{
+					WeakWindow.Pin()->RequestDestroyWindow();
+					return FReply::Handled();
+				})
+			]
+		]);
+
+	GEditor->EditorAddModalWindow(Window);
+	Settings->RemoveFromRoot();
+
+	if (!bBake)
+	{
+		return;
+	}
+
+	// Remember the settings for next time, and for the bake commandlet
+	Settings->SaveConfig();
+	GetMutableDefault<UCurveIKBakeSettings>()->ReloadConfig();
+
+	TArray<UAnimSequence*> Baked;
+	int32 NumBaked = 0;
+	{
+		FScopedSlowTask SlowTask(0.f, LOCTEXT("CurveIKBakeProgress", "Baking CurveIK..."));
+		SlowTask.MakeDialog();
+		NumBaked = CurveIKBake::BakeSequences(Sequences, *Settings, Baked);
+	}
+
+	FNotificationInfo Info(FText::Format(LOCTEXT("CurveIKBakeResult", "Baked CurveIK into {0} of {1} sequences. See the output log for details."),
+	                                     FText::AsNumber(NumBaked), FText::AsNumber(Sequences.Num())));
+	Info.ExpireDuration = 5.f;
+	TSharedPtr<SNotificationItem> Notification = FSlateNotificationManager::Get().AddNotification(Info);
+	if (Notification.IsValid())
+	{
+		Notification->SetCompletionState(NumBaked == Sequences.Num() ? SNotificationItem::CS_Success : SNotificationItem::CS_Fail);
+	}
+}
+
 #undef LOCTEXT_NAMESPACE
 	
-IMPLEMENT_MODULE(FCurveIKEditorModule, CurveIKEditor)
\ No newline at end of file
+IMPLEMENT_MODULE(FCurveIKEditorModule, CurveIKEditor)
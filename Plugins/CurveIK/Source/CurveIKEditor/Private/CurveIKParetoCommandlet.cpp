@@ -0,0 +1,358 @@
+#include "CurveIKParetoCommandlet.h"
+#include "CurveIKCore.h"
+#include "CurveIKTestChains.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCurveIKPareto, Log, All);
+
+namespace CurveIKPareto
+{
+	/** The parameter grid */
+	static const int32 CurveDetails[] = { 8, 12, 16, 20, 32, 64 };
+	static const int32 IterationCounts[] = { 10, 20, 50, 100, 200 };
+	static const float Tolerances[] = { 0.1f, 0.01f, 0.001f };
+	static const ECurveIKCurveType CurveTypes[] = { ECurveIKCurveType::QuadraticBezier, ECurveIKCurveType::CubicBezier };
+
+	/** Node settings that are not swept. Match the FAnimNode_CurveIK defaults. */
+	static const float ControlPointWeight = 0.5f;
+	static const float HandleAngle = 0.f;
+	static const float Stretch = 0.f;
+
+	/** A chain and the path its target follows, one target per frame. The chain's own Target is not used. */
+	struct FTestChain : public FCurveIKTestChain
+	{
+		TArray<FVector> Targets;
+	};
+
+	/** Builds a chain of 4-16 links whose target circles through the middle of its reach */
+	static FTestChain MakeChain(FRandomStream& Random, int32 NumFrames)
+	{
+		FTestChain Chain;
+		static_cast<FCurveIKTestChain&>(Chain) = CurveIK_AnimationCore::MakeRandomChain(Random, FVector::ZeroVector, 4, 16, 5.f, 20.f);
+
+		// A circle around a point at 60% of the reach, small enough to stay between 35% and 85% of it
+		const FVector Center = Random.GetUnitVector() * Chain.MaximumReach * 0.6f;
+		FVector AxisX, AxisY;
+		Random.GetUnitVector().FindBestAxisVectors(AxisX, AxisY);
+		const float Radius = Chain.MaximumReach * 0.25f;
+		for (int32 Frame = 0; Frame < NumFrames; Frame++)
+		{
+			const float Angle = 2.f * PI * Frame / NumFrames;
+			Chain.Targets.Add(Center + (AxisX * FMath::Cos(Angle) + AxisY * FMath::Sin(Angle)) * Radius);
+		}
+
+		return Chain;
+	}
+
+	struct FSettings
+	{
+		ECurveIKCurveType CurveType;
+		int32 CurveDetail;
+		int32 MaxIterations;
+		float CurveFitTolerance;
+	};
+
+	struct FMeasurement
+	{
+		FSettings Settings;
+		/** Median over the timing repeats */
+		double MicrosecondsPerSolve = 0.0;
+		double MeanTipError = 0.0;
+		float MaxTipError = 0.f;
+
+		/** Largest difference between a link's solved and bone length, as a fraction of the bone length */
+		float MaxLengthError = 0.f;
+
+		/** Mean change in degrees of each bone's frame to frame roll about its length. Zero for perfectly smooth motion. */
+		double MeanRollJitter = 0.0;
+
+		bool bPareto = false;
+	};
+
+	static FCurveIKSolveResult Solve(TArray<FCurveIKChainLink>& Links, const FVector& Target, float MaximumReach, const FSettings& Settings)
+	{
+		return CurveIK_AnimationCore::SolveCurveIK(Links, Target, ControlPointWeight, MaximumReach, Settings.MaxIterations,
+		                                           Settings.CurveFitTolerance, Settings.CurveDetail, Stretch, nullptr, HandleAngle,
+		                                           Settings.CurveType);
+	}
+
+	/** Accuracy of the solves over every chain's target path, timed separately by Time */
+	static void MeasureAccuracy(TArray<FTestChain>& Chains, const FSettings& Settings, FMeasurement& Measurement)
+	{
+		int64 NumSolves = 0;
+		int64 NumJitterSamples = 0;
+		TArray<FQuat> Rotations;
+		TArray<FQuat> PrevRotations;
+		TArray<float> PrevRollRates;
+
+		for (FTestChain& Chain : Chains)
+		{
+			PrevRotations.Reset();
+			PrevRollRates.Reset();
+			for (const FVector& Target : Chain.Targets)
+			{
+				const FCurveIKSolveResult Result = Solve(Chain.Links, Target, Chain.MaximumReach, Settings);
+				Measurement.MeanTipError += Result.TipError;
+				Measurement.MaxTipError = FMath::Max(Measurement.MaxTipError, Result.TipError);
+				NumSolves++;
+
+				for (int32 LinkIndex = 1; LinkIndex < Chain.Links.Num(); LinkIndex++)
+				{
+					const FCurveIKChainLink& Link = Chain.Links[LinkIndex];
+					const float Length = FVector::Dist(Link.Position, Chain.Links[LinkIndex - 1].Position);
+					Measurement.MaxLengthError = FMath::Max(Measurement.MaxLengthError, FMath::Abs(Length - Link.Length) / Link.Length);
+				}
+
+				// Roll is the twist of each bone about its own length between frames, as the anim node would orient it
+				CurveIK_AnimationCore::GetSolvedBoneRotations(Chain.Links, Rotations);
+				if (PrevRotations.Num() == Rotations.Num())
+				{
+					const bool bHasPrevRates = PrevRollRates.Num() == Rotations.Num();
+					PrevRollRates.SetNum(Rotations.Num());
+					for (int32 BoneIndex = 0; BoneIndex < Rotations.Num(); BoneIndex++)
+					{
+						const float RollRate = CurveIK_AnimationCore::GetBoneRoll(PrevRotations[BoneIndex], Rotations[BoneIndex]);
+						if (bHasPrevRates)
+						{
+							Measurement.MeanRollJitter += FMath::Abs(FRotator::NormalizeAxis(RollRate - PrevRollRates[BoneIndex]));
+							NumJitterSamples++;
+						}
+						PrevRollRates[BoneIndex] = RollRate;
+					}
+				}
+				Swap(PrevRotations, Rotations);
+			}
+		}
+
+		Measurement.MeanTipError /= FMath::Max<int64>(NumSolves, 1);
+		Measurement.MeanRollJitter /= FMath::Max<int64>(NumJitterSamples, 1);
+	}
+
+	/** Median time per solve over NumRepeats passes through every chain's target path */
+	static double Time(TArray<FTestChain>& Chains, const FSettings& Settings, int32 NumRepeats)
+	{
+		int64 NumSolves = 0;
+		for (const FTestChain& Chain : Chains)
+		{
+			NumSolves += Chain.Targets.Num();
+		}
+
+		TArray<double> Microseconds;
+		for (int32 Repeat = 0; Repeat < NumRepeats; Repeat++)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			for (FTestChain& Chain : Chains)
+			{
+				for (const FVector& Target : Chain.Targets)
+				{
+					Solve(Chain.Links, Target, Chain.MaximumReach, Settings);
+				}
+			}
+			Microseconds.Add((FPlatformTime::Seconds() - StartTime) * 1000000.0 / FMath::Max<int64>(NumSolves, 1));
+		}
+
+		Microseconds.Sort();
+		return Microseconds[Microseconds.Num() / 2];
+	}
+
+	static FMeasurement Measure(TArray<FTestChain>& Chains, const FSettings& Settings, int32 NumRepeats)
+	{
+		FMeasurement Measurement;
+		Measurement.Settings = Settings;
+		MeasureAccuracy(Chains, Settings, Measurement);
+		Measurement.MicrosecondsPerSolve = Time(Chains, Settings, NumRepeats);
+		return Measurement;
+	}
+
+	/** True if A is at least as good as B on every measure and better on one */
+	static bool Dominates(const FMeasurement& A, const FMeasurement& B)
+	{
+		const double ValuesA[] = { A.MicrosecondsPerSolve, A.MeanTipError, A.MaxLengthError, A.MeanRollJitter };
+		const double ValuesB[] = { B.MicrosecondsPerSolve, B.MeanTipError, B.MaxLengthError, B.MeanRollJitter };
+
+		bool bBetter = false;
+		for (int32 Index = 0; Index < ARRAY_COUNT(ValuesA); Index++)
+		{
+			if (ValuesA[Index] > ValuesB[Index])
+			{
+				return false;
+			}
+			bBetter |= ValuesA[Index] < ValuesB[Index];
+		}
+		return bBetter;
+	}
+
+	static FString GetLabel(const FSettings& Settings)
+	{
+		return FString::Printf(TEXT("%s detail %d, %d iterations, tolerance %g"), LexToString(Settings.CurveType),
+		                       Settings.CurveDetail, Settings.MaxIterations, Settings.CurveFitTolerance);
+	}
+
+	static double LogOf(double Value, double Floor)
+	{
+		return FMath::Loge(float(FMath::Max(Value, Floor)));
+	}
+
+	/** A log-log scatter of time per solve against mean tip error, with the Pareto set highlighted and joined */
+	static FString MakeHtml(const TArray<FMeasurement>& Measurements)
+	{
+		const float Width = 900.f;
+		const float Height = 600.f;
+		const float Margin = 60.f;
+
+		// Log extents of the data, widened slightly so a single point does not divide by zero
+		double MinX = MAX_dbl, MaxX = -MAX_dbl, MinY = MAX_dbl, MaxY = -MAX_dbl;
+		for (const FMeasurement& Measurement : Measurements)
+		{
+			MinX = FMath::Min(MinX, LogOf(Measurement.MicrosecondsPerSolve, 1e-3));
+			MaxX = FMath::Max(MaxX, LogOf(Measurement.MicrosecondsPerSolve, 1e-3) + 1e-3);
+			MinY = FMath::Min(MinY, LogOf(Measurement.MeanTipError, 1e-6));
+			MaxY = FMath::Max(MaxY, LogOf(Measurement.MeanTipError, 1e-6) + 1e-3);
+		}
+
+		auto ToX = [&](double Value) { return Margin + (LogOf(Value, 1e-3) - MinX) / (MaxX - MinX) * (Width - 2.f * Margin); };
+		auto ToY = [&](double Value) { return Height - Margin - (LogOf(Value, 1e-6) - MinY) / (MaxY - MinY) * (Height - 2.f * Margin); };
+
+		FString Html;
+		Html += TEXT("<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\"><title>CurveIK accuracy against cost</title></head><body>\n");
+		Html += TEXT("<h1>CurveIK accuracy against cost</h1>\n");
+		Html += TEXT("<p>Median time per solve against mean tip error, both on log scales. Red points are Pareto optimal across time, tip error, ")
+			TEXT("bone length error and bone roll jitter. Hover a point for its settings.</p>\n");
+		Html += FString::Printf(TEXT("<svg width=\"%.0f\" height=\"%.0f\" style=\"font-family:sans-serif;font-size:12px\">\n"), Width, Height);
+		Html += FString::Printf(TEXT("<line x1=\"%.0f\" y1=\"%.0f\" x2=\"%.0f\" y2=\"%.0f\" stroke=\"black\"/>\n"), Margin, Height - Margin, Width - Margin, Height - Margin);
+		Html += FString::Printf(TEXT("<line x1=\"%.0f\" y1=\"%.0f\" x2=\"%.0f\" y2=\"%.0f\" stroke=\"black\"/>\n"), Margin, Margin, Margin, Height - Margin);
+		Html += FString::Printf(TEXT("<text x=\"%.0f\" y=\"%.0f\" text-anchor=\"middle\">Time per solve (us)</text>\n"), Width * 0.5f, Height - 15.f);
+		Html += FString::Printf(TEXT("<text x=\"15\" y=\"%.0f\" transform=\"rotate(-90 15 %.0f)\" text-anchor=\"middle\">Mean tip error (cm)</text>\n"), Height * 0.5f, Height * 0.5f);
+
+		// Axis extents
+		Html += FString::Printf(TEXT("<text x=\"%.0f\" y=\"%.0f\">%.2f</text>\n"), Margin, Height - Margin + 15.f, FMath::Exp(float(MinX)));
+		Html += FString::Printf(TEXT("<text x=\"%.0f\" y=\"%.0f\" text-anchor=\"end\">%.2f</text>\n"), Width - Margin, Height - Margin + 15.f, FMath::Exp(float(MaxX)));
+		Html += FString::Printf(TEXT("<text x=\"%.0f\" y=\"%.0f\" text-anchor=\"end\">%.2g</text>\n"), Margin - 4.f, Height - Margin, FMath::Exp(float(MinY)));
+		Html += FString::Printf(TEXT("<text x=\"%.0f\" y=\"%.0f\" text-anchor=\"end\">%.2g</text>\n"), Margin - 4.f, Margin, FMath::Exp(float(MaxY)));
+
+		TArray<const FMeasurement*> Front;
+		for (const FMeasurement& Measurement : Measurements)
+		{
+			if (Measurement.bPareto)
+			{
+				Front.Add(&Measurement);
+			}
+		}
+		Front.Sort([](const FMeasurement& A, const FMeasurement& B) { return A.MicrosecondsPerSolve < B.MicrosecondsPerSolve; });
+
+		FString Polyline;
+		for (const FMeasurement* Measurement : Front)
+		{
+			Polyline += FString::Printf(TEXT("%.1f,%.1f "), ToX(Measurement->MicrosecondsPerSolve), ToY(Measurement->MeanTipError));
+		}
+		Html += FString::Printf(TEXT("<polyline points=\"%s\" fill=\"none\" stroke=\"red\" stroke-opacity=\"0.4\"/>\n"), *Polyline);
+
+		for (const FMeasurement& Measurement : Measurements)
+		{
+			Html += FString::Printf(TEXT("<circle cx=\"%.1f\" cy=\"%.1f\" r=\"%d\" fill=\"%s\"><title>%s\n%.2f us, tip error %.4f, length error %.2f%%, roll jitter %.3f deg</title></circle>\n"),
+			                        ToX(Measurement.MicrosecondsPerSolve), ToY(Measurement.MeanTipError), Measurement.bPareto ? 5 : 3,
+			                        Measurement.bPareto ? TEXT("red") : TEXT("gray"), *GetLabel(Measurement.Settings),
+			                        Measurement.MicrosecondsPerSolve, Measurement.MeanTipError, Measurement.MaxLengthError * 100.f, Measurement.MeanRollJitter);
+		}
+		Html += TEXT("</svg>\n");
+
+		Html += TEXT("<h2>Pareto optimal settings</h2>\n<table border=\"1\" cellpadding=\"4\" style=\"border-collapse:collapse\">\n");
+		Html += TEXT("<tr><th>Settings</th><th>us per solve</th><th>Mean tip error</th><th>Max length error</th><th>Roll jitter (deg)</th></tr>\n");
+		for (const FMeasurement* Measurement : Front)
+		{
+			Html += FString::Printf(TEXT("<tr><td>%s</td><td>%.2f</td><td>%.4f</td><td>%.2f%%</td><td>%.3f</td></tr>\n"),
+			                        *GetLabel(Measurement->Settings), Measurement->MicrosecondsPerSolve, Measurement->MeanTipError,
+			                        Measurement->MaxLengthError * 100.f, Measurement->MeanRollJitter);
+		}
+		Html += TEXT("</table>\n</body></html>\n");
+
+		return Html;
+	}
+}
+
+UCurveIKParetoCommandlet::UCurveIKParetoCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UCurveIKParetoCommandlet::Main(const FString& Params)
+{
+	using namespace CurveIKPareto;
+
+	int32 NumChains = 32;
+	int32 NumFrames = 60;
+	int32 NumRepeats = 5;
+	FString OutputDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("CurveIK"));
+
+	FParse::Value(*Params, TEXT("Chains="), NumChains);
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+	FParse::Value(*Params, TEXT("Repeats="), NumRepeats);
+	FParse::Value(*Params, TEXT("Out="), OutputDir);
+	NumChains = FMath::Max(NumChains, 1);
+	NumFrames = FMath::Max(NumFrames, 3);
+	NumRepeats = FMath::Max(NumRepeats, 1);
+
+	// The chain set is the same on every run, so reports can be compared
+	FRandomStream Random(0);
+	TArray<FTestChain> Chains;
+	for (int32 ChainIndex = 0; ChainIndex < NumChains; ChainIndex++)
+	{
+		Chains.Add(MakeChain(Random, NumFrames));
+	}
+
+	TArray<FMeasurement> Measurements;
+	for (const ECurveIKCurveType CurveType : CurveTypes)
+	{
+		for (const int32 CurveDetail : CurveDetails)
+		{
+			for (const int32 MaxIterations : IterationCounts)
+			{
+				for (const float CurveFitTolerance : Tolerances)
+				{
+					Measurements.Add(Measure(Chains, { CurveType, CurveDetail, MaxIterations, CurveFitTolerance }, NumRepeats));
+				}
+			}
+		}
+	}
+
+	for (FMeasurement& Measurement : Measurements)
+	{
+		Measurement.bPareto = !Measurements.ContainsByPredicate([&Measurement](const FMeasurement& Other)
+		{
+			return Dominates(Other, Measurement);
+		});
+	}
+
+	TArray<FString> Rows;
+	Rows.Add(TEXT("curve_type,curve_detail,max_iterations,curve_fit_tolerance,us_per_solve,mean_tip_error,max_tip_error,max_length_error,mean_roll_jitter_deg,pareto"));
+	for (const FMeasurement& Measurement : Measurements)
+	{
+		Rows.Add(FString::Printf(TEXT("%s,%d,%d,%g,%.3f,%.5f,%.5f,%.5f,%.4f,%d"),
+		                         LexToString(Measurement.Settings.CurveType), Measurement.Settings.CurveDetail, Measurement.Settings.MaxIterations,
+		                         Measurement.Settings.CurveFitTolerance, Measurement.MicrosecondsPerSolve, Measurement.MeanTipError,
+		                         Measurement.MaxTipError, Measurement.MaxLengthError, Measurement.MeanRollJitter, Measurement.bPareto ? 1 : 0));
+		if (Measurement.bPareto)
+		{
+			UE_LOG(LogCurveIKPareto, Display, TEXT("Pareto optimal: %s"), *Rows.Last());
+		}
+	}
+
+	const FString CsvPath = FPaths::Combine(OutputDir, TEXT("Pareto.csv"));
+	const FString HtmlPath = FPaths::Combine(OutputDir, TEXT("Pareto.html"));
+	if (!FFileHelper::SaveStringArrayToFile(Rows, *CsvPath) || !FFileHelper::SaveStringToFile(MakeHtml(Measurements), *HtmlPath))
+	{
+		UE_LOG(LogCurveIKPareto, Error, TEXT("Failed to write the report to %s"), *OutputDir);
+		return 1;
+	}
+
+	UE_LOG(LogCurveIKPareto, Display, TEXT("Wrote %d measurements to %s and %s"), Measurements.Num(), *CsvPath, *HtmlPath);
+	return 0;
+}
@@ -0,0 +1,73 @@
+#include "CurveIKReplayCommandlet.h"
+#include "CurveIKTrace.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCurveIKReplay, Log, All);
+
+UCurveIKReplayCommandlet::UCurveIKReplayCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UCurveIKReplayCommandlet::Main(const FString& Params)
+{
+	FString TracePath;
+	int32 NumRepeats = 1;
+	if (!FParse::Value(*Params, TEXT("Trace="), TracePath))
+	{
+		UE_LOG(LogCurveIKReplay, Error, TEXT("Pass the trace to replay with -Trace=Path"));
+		return 1;
+	}
+	FParse::Value(*Params, TEXT("Repeats="), NumRepeats);
+	NumRepeats = FMath::Max(NumRepeats, 1);
+
+	// Map the trace rather than reading it, so large captures replay without a copy
+	TUniquePtr<IMappedFileHandle> MappedFile(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*TracePath));
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	TArray<uint8> LoadedTrace;
+	const uint8* Data = nullptr;
+	int64 Size = 0;
+
+	if (MappedFile)
+	{
+		MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	}
+	if (MappedRegion)
+	{
+		Data = MappedRegion->GetMappedPtr();
+		Size = MappedRegion->GetMappedSize();
+	}
+	else if (FFileHelper::LoadFileToArray(LoadedTrace, *TracePath))
+	{
+		UE_LOG(LogCurveIKReplay, Display, TEXT("Memory mapping is not available, loaded %s instead"), *TracePath);
+		Data = LoadedTrace.GetData();
+		Size = LoadedTrace.Num();
+	}
+	else
+	{
+		UE_LOG(LogCurveIKReplay, Error, TEXT("Failed to open %s"), *TracePath);
+		return 1;
+	}
+
+	const FCurveIKTraceReplayStats Stats = CurveIKTrace::Replay(Data, Size, NumRepeats);
+	if (!Stats.bValid)
+	{
+		UE_LOG(LogCurveIKReplay, Error, TEXT("%s is not a CurveIK trace, or is truncated. Replayed the %d solves before the error."), *TracePath, Stats.NumSolves);
+	}
+
+	const int32 NumSolved = Stats.NumSolves * NumRepeats;
+	UE_LOG(LogCurveIKReplay, Display, TEXT("Replayed %d solves from %d streams %d times: %.3f s, %.1f solves per second"),
+	       Stats.NumSolves, Stats.NumStreams, NumRepeats, Stats.SolveSeconds, NumSolved / FMath::Max(Stats.SolveSeconds, double(SMALL_NUMBER)));
+	UE_LOG(LogCurveIKReplay, Display, TEXT("Verified %d solves against the recording, %d mismatched%s"),
+	       Stats.NumVerified, Stats.NumMismatched,
+	       Stats.FirstMismatch != INDEX_NONE ? *FString::Printf(TEXT(", the first at solve %d"), Stats.FirstMismatch) : TEXT(""));
+
+	return Stats.bValid && Stats.NumMismatched == 0 ? 0 : 1;
+}
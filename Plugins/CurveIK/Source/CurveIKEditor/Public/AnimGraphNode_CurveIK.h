@@ -7,7 +7,12 @@
 #include "AnimGraphNode_CurveIK.generated.h"
 
 
+class FCanvas;
 class FPrimitiveDrawInterface;
+class FSceneView;
+class FViewport;
+class UGraphNodeContextMenuContext;
+class UToolMenu;
 class USkeletalMeshComponent;
 
 UCLASS()
@@ -18,6 +23,14 @@ class UAnimGraphNode_CurveIK : public UAnimGraphNode_SkeletalControlBase
 		UPROPERTY(EditAnywhere, Category = Settings)
 		FAnimNode_CurveIK Node;
 
+	/** Largest tip to target distance the autotuner will accept */
+	UPROPERTY(EditAnywhere, Category = Autotune, meta = (ClampMin = "0.0"))
+	float AutotuneTipErrorBudget;
+
+	/** Largest bone roll difference in degrees from a high quality solve that the autotuner will accept */
+	UPROPERTY(EditAnywhere, Category = Autotune, meta = (ClampMin = "0.0"))
+	float AutotuneRollErrorBudget;
+
 public:
 	// UObject interface
 	virtual void Serialize(FArchive& Ar) override;
@@ -25,14 +38,20 @@ public:
 
 	// UEdGraphNode interface
 	virtual FText GetNodeTitle(ENodeTitleType::Type TitleType) const override;
+	virtual void GetNodeContextMenuActions(UToolMenu* Menu, UGraphNodeContextMenuContext* Context) const override;
 	// End of UEdGraphNode interface
 
 	// UAnimGraphNode_Base interface
 	virtual void CopyNodeDataToPreviewNode(FAnimNode_Base* AnimNode) override;
 	virtual FEditorModeID GetEditorMode() const override;
 	virtual void Draw(FPrimitiveDrawInterface* PDI, USkeletalMeshComponent* PreviewSkelMeshComp) const override;
+	virtual void DrawCanvas(FViewport& InViewport, FSceneView& View, FCanvas& Canvas, USkeletalMeshComponent* PreviewSkelMeshComp) const override;
+	virtual void GetOnScreenDebugInfo(TArray<FText>& DebugInfo, FAnimNode_Base* RuntimeAnimNode, USkeletalMeshComponent* PreviewSkelMeshComp) const override;
 	// End of UAnimGraphNode_Base interface
 
+	/** Finds the cheapest solver settings that meet the autotune budgets for the target skeleton and writes them to the node */
+	void AutotuneSolverSettings();
+
 protected:
 	// UAnimGraphNode_SkeletalControlBase interface
 	virtual FText GetControllerDescription() const override;
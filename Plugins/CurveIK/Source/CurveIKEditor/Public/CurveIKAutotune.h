@@ -0,0 +1,47 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CurveIKCore.h"
+
+struct FAnimNode_CurveIK;
+struct FReferenceSkeleton;
+
+/** Solver settings chosen by the autotuner and how they performed */
+struct FCurveIKAutotuneResult
+{
+	/** False if no candidate met the error budgets. The remaining fields then describe the most accurate candidate. */
+	bool bWithinBudget = false;
+
+	int32 CurveDetail = 0;
+	int32 MaxIterations = 0;
+	float CurveFitTolerance = 0.f;
+
+	/** Largest distance between the tip and a target across the sweep */
+	float MaxTipError = 0.f;
+
+	/** Largest angle in degrees that a solved bone is rolled about its length from the reference solve of the same target */
+	float MaxRollError = 0.f;
+
+	/** Measured average time of a single solve at the chosen settings */
+	float SolveTimeMicroseconds = 0.f;
+};
+
+namespace CurveIKAutotune
+{
+	/**
+	 * Gathers the reference pose lengths of the links between RootBone and TipBone.
+	 *
+	 * @return False if TipBone is not a descendant of RootBone
+	 */
+	bool GatherLinkLengths(const FReferenceSkeleton& RefSkeleton, FName RootBone, FName TipBone, TArray<float>& OutLinkLengths);
+
+	/**
+	 * Sweeps targets across the reachable workspace of a chain with the given link lengths and finds the cheapest
+	 * CurveDetail, MaxIterations and CurveFitTolerance whose tip and roll errors stay within budget. The remaining
+	 * solver settings are taken from Node, and candidates are solved as Node would solve them, with its maximum curve
+	 * error, shared curve cache and precomputed handle heights. When Node has a maximum curve error, its CurveDetail is
+	 * kept, since the solver does not use it.
+	 */
+	FCurveIKAutotuneResult FindCheapestSettings(const TArray<float>& LinkLengths, const FAnimNode_CurveIK& Node,
+	                                            float TipErrorBudget, float RollErrorBudget);
+}
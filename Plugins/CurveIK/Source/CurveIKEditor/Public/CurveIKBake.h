@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "CurveIKTypes.h"
+#include "CurveIKBake.generated.h"
+
+class UAnimSequence;
+struct FAnimNode_CurveIK;
+
+/**
+ * Settings for baking CurveIK into animation sequences. The effector follows a bone of the source animation, such as
+ * an IK bone, and the solved chain is written into a copy of the sequence. Remembered between editor sessions.
+ */
+UCLASS(config = EditorPerProjectUserSettings)
+class UCurveIKBakeSettings : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UCurveIKBakeSettings();
+
+	/** Name of the root bone */
+	UPROPERTY(EditAnywhere, config, Category = Chain)
+	FName RootBone;
+
+	/** Name of the tip bone */
+	UPROPERTY(EditAnywhere, config, Category = Chain)
+	FName TipBone;
+
+	/** The bone whose animated location the tip is solved towards */
+	UPROPERTY(EditAnywhere, config, Category = Chain)
+	FName EffectorBone;
+
+	/** Appended to the source sequence's name to name the baked sequence, which is saved next to it. Existing assets are never replaced. */
+	UPROPERTY(EditAnywhere, config, Category = Output)
+	FString Suffix;
+
+	UPROPERTY(EditAnywhere, config, Category = Solver, meta = (ClampMin = "0", ClampMax = "1", UIMin = "0", UIMax = "1"))
+	float ControlPointWeight;
+
+	UPROPERTY(EditAnywhere, config, Category = Solver)
+	TEnumAsByte<enum EIKCurveTypes> CurveType;
+
+	UPROPERTY(EditAnywhere, config, Category = Solver, meta = (ClampMin = "1"))
+	int32 MaxIterations;
+
+	UPROPERTY(EditAnywhere, config, Category = Solver, meta = (ClampMin = "2"))
+	int32 CurveDetail;
+
+	UPROPERTY(EditAnywhere, config, Category = Solver, meta = (ClampMin = "0"))
+	float MaxCurveError;
+
+	UPROPERTY(EditAnywhere, config, Category = Solver)
+	float CurveFitTolerance;
+
+	UPROPERTY(EditAnywhere, config, Category = Solver, meta = (ClampMin = "0", ClampMax = "1", UIMin = "0", UIMax = "1"))
+	float Stretch;
+
+	UPROPERTY(EditAnywhere, config, Category = Solver, meta = (ClampMin = "-360", ClampMax = "360", UIMin = "-360", UIMax = "360"))
+	float HandleAngle;
+
+	/** Copies the chain and solver settings onto Node, with the effector following EffectorBone */
+	void ApplyTo(FAnimNode_CurveIK& Node) const;
+};
+
+namespace CurveIKBake
+{
+	/**
+	 * Runs CurveIK over every frame of each source sequence and saves the result as a new sequence next to it.
+	 * Sequences are sampled and solved in parallel; assets are created on the calling thread, which must be the game thread.
+	 *
+	 * @param OutBaked Receives one entry per source: the baked sequence, or null if the source could not be baked or a
+	 *                 sequence of the baked name already exists
+	 * @return Number of sequences baked
+	 */
+	int32 BakeSequences(const TArray<UAnimSequence*>& Sources, const UCurveIKBakeSettings& Settings, TArray<UAnimSequence*>& OutBaked);
+}
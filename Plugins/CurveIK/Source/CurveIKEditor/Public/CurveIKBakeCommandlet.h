@@ -0,0 +1,23 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CurveIKBakeCommandlet.generated.h"
+
+/**
+ * Bakes CurveIK into animation sequences, see CurveIKBake::BakeSequences. Settings default to those last used in the
+ * editor and can be overridden on the command line. Sequences are given as package names, or found under a content path.
+ *
+ * Usage: UE4Editor-Cmd <Project> -run=CurveIKBake -unattended (-Sequences=A,B,... | -Path=/Game/Dir)
+ *        [-Root=Bone] [-Tip=Bone] [-Effector=Bone] [-Suffix=_CurveIK] [-MaxIterations=N] [-CurveDetail=N] [-CurveFitTolerance=X]
+ */
+UCLASS()
+class UCurveIKBakeCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	// UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// End of UCommandlet interface
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CurveIKBenchmarkCommandlet.generated.h"
+
+/**
+ * Headless benchmark for CurveIK_AnimationCore::SolveCurveIK.
+ *
+ * Solves a set of randomized chains for every curve type and parameter preset, once one chain at a time and
+ * once through the batched SIMD kernel, and writes one CSV row per combination to the log and to an output file.
+ *
+ * Usage: UE4Editor-Cmd <Project> -run=CurveIKBenchmark -nullrhi -unattended [-Seed=N] [-Chains=N] [-Repeats=N] [-Out=Path]
+ */
+UCLASS()
+class UCurveIKBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	// UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// End of UCommandlet interface
+};
@@ -18,6 +18,33 @@ public:
 	virtual void Render(const FSceneView* View, FViewport* Viewport, FPrimitiveDrawInterface* PDI) override;
 
 private:
+	/** Packs the node's debug draw toggles, so the cached geometry can be rebuilt when they change */
+	uint8 GetDebugDrawFlags() const;
+
+	/** Rebuilds DebugLines and DebugPoints from a debug snapshot published by the runtime node */
+	void RebuildDebugGeometry(const struct FCurveIKDebugSnapshot& Snapshot);
+
+	struct FDebugLine
+	{
+		FVector Start;
+		FVector End;
+		FLinearColor Color;
+	};
+
+	struct FDebugPoint
+	{
+		FVector Position;
+		FLinearColor Color;
+		float Size;
+	};
+
 	struct FAnimNode_CurveIK* RuntimeNode;
 	class UAnimGraphNode_CurveIK* GraphNode;
+
+	/** Debug geometry built from the runtime node, drawn every frame until the solver output changes */
+	TArray<FDebugLine> DebugLines;
+	TArray<FDebugPoint> DebugPoints;
+	uint32 CachedDebugDataVersion = 0;
+	uint8 CachedDebugDrawFlags = 0;
+	bool bDebugGeometryValid = false;
 };
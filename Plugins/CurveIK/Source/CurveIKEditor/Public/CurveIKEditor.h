@@ -3,6 +3,8 @@
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
 
+class UAnimSequence;
+
 class FCurveIKEditorModule : public IModuleInterface
 {
 public:
@@ -10,4 +12,11 @@ public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+private:
+	/** Adds Bake CurveIK to the content browser context menu of animation sequences */
+	void RegisterMenus();
+
+	/** Asks for bake settings, then bakes Sequences */
+	static void BakeSequences(TArray<UAnimSequence*> Sequences);
 };
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CurveIKParetoCommandlet.generated.h"
+
+/**
+ * Sweeps CurveDetail, MaxIterations, CurveFitTolerance and the curve type over a standard set of chains following
+ * smooth target paths. Measures time per solve, tip error, bone length error and frame to frame jitter in the roll of
+ * the solved bones for every combination, and marks the combinations that no other beats on all four. Each combination
+ * is timed Repeats times and the median is reported.
+ *
+ * Writes Pareto.csv and Pareto.html, a chart of cost against tip error, to the output directory.
+ *
+ * Usage: UE4Editor-Cmd <Project> -run=CurveIKPareto -nullrhi -unattended [-Chains=N] [-Frames=N] [-Repeats=N] [-Out=Dir]
+ */
+UCLASS()
+class UCurveIKParetoCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	// UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// End of UCommandlet interface
+};
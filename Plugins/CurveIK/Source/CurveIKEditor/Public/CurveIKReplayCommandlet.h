@@ -0,0 +1,22 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CurveIKReplayCommandlet.generated.h"
+
+/**
+ * Replays a CurveIK trace recorded with CurveIK.Trace.Start. The trace is memory mapped and every recorded solve is
+ * run through CurveIK_AnimationCore::SolveCurveIK as fast as possible, then checked against the recorded results.
+ *
+ * Usage: UE4Editor-Cmd <Project> -run=CurveIKReplay -nullrhi -unattended -Trace=Path [-Repeats=N]
+ */
+UCLASS()
+class UCurveIKReplayCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	// UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// End of UCommandlet interface
+};
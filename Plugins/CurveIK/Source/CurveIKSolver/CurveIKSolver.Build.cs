@@ -0,0 +1,21 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+/*
+ * The CurveIK math core: curves, curve cache and SolveCurveIK. It depends on Core only, so it can be
+ * linked into small native programs for testing and profiling without UObjects or the Engine.
+ */
+public class CurveIKSolver : ModuleRules
+{
+	public CurveIKSolver(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(
+			new string[] {
+					"Core",
+			}
+			);
+	}
+}
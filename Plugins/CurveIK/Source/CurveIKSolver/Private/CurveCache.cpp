@@ -9,7 +9,7 @@ void FCurveIK_CurveCache::Add(float ArcLength, FVector CurvePosition, float T)
 	CurveCache.Add(Item);
 }
 
-FCurvePoint FCurveIK_CurveCache::Get(int Index)
+FCurvePoint FCurveIK_CurveCache::Get(int Index) const
 {
 	return CurveCache[Index];
 }
@@ -70,3 +70,13 @@ TArray<FVector> FCurveIK_CurveCache::GetPoints()
 	}
 	return  Points;
 }
+
+void FCurveIK_CurveCache::Transform(const FTransform& Transform)
+{
+	const float Scale = Transform.GetMaximumAxisScale();
+	for (FCurvePoint& CacheItem : CurveCache)
+	{
+		CacheItem.ArcLength *= Scale;
+		CacheItem.Point = Transform.TransformPosition(CacheItem.Point);
+	}
+}
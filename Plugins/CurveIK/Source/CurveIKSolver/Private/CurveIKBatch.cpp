@@ -0,0 +1,373 @@
+#include "CurveIKBatch.h"
+#include "CurveIKCorePrivate.h"
+#include "CurveIKStats.h"
+#include "IKCurves/IKCurveCubicBezier.h"
+#include "Math/VectorRegister.h"
+
+namespace CurveIK_AnimationCore
+{
+	/**
+	 * What one lane needs to build its curves. The first handle sits at Handle1Start + Handle1Dir * Height and the
+	 * second at Handle2Start + Handle2Dir * Height, so quadratic curves use a zero Handle2Dir to pin it to P2.
+	 */
+	struct FBatchLane
+	{
+		FVector P1;
+		FVector P2;
+		FVector Handle1Start;
+		FVector Handle1Dir;
+		FVector Handle2Start;
+		FVector Handle2Dir;
+		float TargetArcLength;
+		float HandleHeight;
+		float MaxHandleHeight;
+	};
+
+	/** Points sampled on the last curve of every lane, interleaved so that sample I of lane L is at I * BatchLaneCount + L */
+	struct FBatchSamples
+	{
+		TArray<float> ArcLengths;
+		TArray<float> X;
+		TArray<float> Y;
+		TArray<float> Z;
+
+		void Init(int32 NumPoints)
+		{
+			ArcLengths.SetNumUninitialized(NumPoints * BatchLaneCount);
+			X.SetNumUninitialized(NumPoints * BatchLaneCount);
+			Y.SetNumUninitialized(NumPoints * BatchLaneCount);
+			Z.SetNumUninitialized(NumPoints * BatchLaneCount);
+		}
+
+		FVector GetPoint(int32 Sample, int32 Lane) const
+		{
+			const int32 Index = Sample * BatchLaneCount + Lane;
+			return FVector(X[Index], Y[Index], Z[Index]);
+		}
+	};
+
+	static FORCEINLINE VectorRegister GatherLanes(const FBatchLane* Lanes, FVector FBatchLane::* Member, int32 Component)
+	{
+		return MakeVectorRegister((Lanes[0].*Member)[Component], (Lanes[1].*Member)[Component],
+		                          (Lanes[2].*Member)[Component], (Lanes[3].*Member)[Component]);
+	}
+
+	static FORCEINLINE VectorRegister GatherLanes(const FBatchLane* Lanes, float FBatchLane::* Member)
+	{
+		return MakeVectorRegister(Lanes[0].*Member, Lanes[1].*Member, Lanes[2].*Member, Lanes[3].*Member);
+	}
+
+	static void SetupLane(const FCurveIKBatchChain& Chain, const FCurveIKBatchSettings& Settings, float Weight, FBatchLane& OutLane)
+	{
+		const FVector P1 = (*Chain.Chain)[0].Position;
+		const FVector P2 = Chain.TargetLocation;
+		const FVector P = P2 - P1;
+		const FVector HandleDir = GetReferenceNormal(P1, P2, FVector::UpVector);
+
+		OutLane.P1 = P1;
+		OutLane.P2 = P2;
+		OutLane.Handle2Start = P2;
+		if (Settings.CurveType == ECurveIKCurveType::QuadraticBezier)
+		{
+			OutLane.Handle1Start = P1 + (P * Weight);
+			OutLane.Handle1Dir = HandleDir;
+			OutLane.Handle2Dir = FVector::ZeroVector;
+		}
+		else
+		{
+			const FVector RotationAxis = FVector::CrossProduct(P, HandleDir).GetSafeNormal();
+			OutLane.Handle1Start = P1;
+			OutLane.Handle1Dir = HandleDir.RotateAngleAxis(Settings.HandleAngle, RotationAxis);
+			OutLane.Handle2Dir = HandleDir.RotateAngleAxis(-Settings.HandleAngle, RotationAxis);
+		}
+
+		OutLane.TargetArcLength = Chain.MaximumReach;
+		OutLane.HandleHeight = IKCurveCubicBezier::GetHandleHeight(P1, P2, Weight, Chain.MaximumReach);
+		OutLane.MaxHandleHeight = Chain.MaximumReach;
+	}
+
+	/**
+	 * Bisects the handle height of every lane at once, exactly like IKCurveCubicBezier::FindCurve does for one curve.
+	 * Lanes at or beyond NumLanes only pad the group and are masked out from the start.
+	 *
+	 * @param Weights Bernstein weights of the four control points at each of NumPoints samples, shared by all lanes
+	 * @param OutSamples Receives the samples of each lane's final curve
+	 */
+	static void FitLanes(const FBatchLane* Lanes, int32 NumLanes, int32 MaxIterations, float CurveFitTolerance, int32 NumPoints,
+	                     const float* Weights, FBatchSamples& OutSamples,
+	                     float* OutHandleHeights, float* OutArcLengths, float* OutIterations)
+	{
+		const VectorRegister AX = GatherLanes(Lanes, &FBatchLane::P1, 0);
+		const VectorRegister AY = GatherLanes(Lanes, &FBatchLane::P1, 1);
+		const VectorRegister AZ = GatherLanes(Lanes, &FBatchLane::P1, 2);
+		const VectorRegister DX = GatherLanes(Lanes, &FBatchLane::P2, 0);
+		const VectorRegister DY = GatherLanes(Lanes, &FBatchLane::P2, 1);
+		const VectorRegister DZ = GatherLanes(Lanes, &FBatchLane::P2, 2);
+		const VectorRegister Handle1StartX = GatherLanes(Lanes, &FBatchLane::Handle1Start, 0);
+		const VectorRegister Handle1StartY = GatherLanes(Lanes, &FBatchLane::Handle1Start, 1);
+		const VectorRegister Handle1StartZ = GatherLanes(Lanes, &FBatchLane::Handle1Start, 2);
+		const VectorRegister Handle1DirX = GatherLanes(Lanes, &FBatchLane::Handle1Dir, 0);
+		const VectorRegister Handle1DirY = GatherLanes(Lanes, &FBatchLane::Handle1Dir, 1);
+		const VectorRegister Handle1DirZ = GatherLanes(Lanes, &FBatchLane::Handle1Dir, 2);
+		const VectorRegister Handle2StartX = GatherLanes(Lanes, &FBatchLane::Handle2Start, 0);
+		const VectorRegister Handle2StartY = GatherLanes(Lanes, &FBatchLane::Handle2Start, 1);
+		const VectorRegister Handle2StartZ = GatherLanes(Lanes, &FBatchLane::Handle2Start, 2);
+		const VectorRegister Handle2DirX = GatherLanes(Lanes, &FBatchLane::Handle2Dir, 0);
+		const VectorRegister Handle2DirY = GatherLanes(Lanes, &FBatchLane::Handle2Dir, 1);
+		const VectorRegister Handle2DirZ = GatherLanes(Lanes, &FBatchLane::Handle2Dir, 2);
+		const VectorRegister TargetArcLength = GatherLanes(Lanes, &FBatchLane::TargetArcLength);
+		const VectorRegister Tolerance = VectorSetFloat1(CurveFitTolerance);
+		const VectorRegister Half = VectorSetFloat1(0.5f);
+		const VectorRegister MinDistSquared = VectorSetFloat1(SMALL_NUMBER);
+
+		VectorRegister HandleHeight = GatherLanes(Lanes, &FBatchLane::HandleHeight);
+		VectorRegister MinHandleHeight = VectorZero();
+		VectorRegister MaxHandleHeight = GatherLanes(Lanes, &FBatchLane::MaxHandleHeight);
+		VectorRegister FitHandleHeight = HandleHeight;
+		VectorRegister FitArcLength = VectorZero();
+		VectorRegister Iterations = VectorZero();
+		VectorRegister Active = VectorCompareLT(MakeVectorRegister(0.f, 1.f, 2.f, 3.f), VectorSetFloat1(float(NumLanes)));
+
+		for (int32 Iteration = 0; Iteration < MaxIterations && VectorMaskBits(Active) != 0; Iteration++)
+		{
+			const VectorRegister BX = VectorMultiplyAdd(Handle1DirX, HandleHeight, Handle1StartX);
+			const VectorRegister BY = VectorMultiplyAdd(Handle1DirY, HandleHeight, Handle1StartY);
+			const VectorRegister BZ = VectorMultiplyAdd(Handle1DirZ, HandleHeight, Handle1StartZ);
+			const VectorRegister CX = VectorMultiplyAdd(Handle2DirX, HandleHeight, Handle2StartX);
+			const VectorRegister CY = VectorMultiplyAdd(Handle2DirY, HandleHeight, Handle2StartY);
+			const VectorRegister CZ = VectorMultiplyAdd(Handle2DirZ, HandleHeight, Handle2StartZ);
+
+			// Every curve starts at its root
+			VectorRegister PrevX = AX;
+			VectorRegister PrevY = AY;
+			VectorRegister PrevZ = AZ;
+			VectorRegister ArcLength = VectorZero();
+			VectorStore(ArcLength, &OutSamples.ArcLengths[0]);
+			VectorStore(AX, &OutSamples.X[0]);
+			VectorStore(AY, &OutSamples.Y[0]);
+			VectorStore(AZ, &OutSamples.Z[0]);
+
+			for (int32 Sample = 1; Sample < NumPoints; Sample++)
+			{
+				const float* SampleWeights = &Weights[Sample * 4];
+				const VectorRegister W0 = VectorLoadFloat1(SampleWeights);
+				const VectorRegister W1 = VectorLoadFloat1(SampleWeights + 1);
+				const VectorRegister W2 = VectorLoadFloat1(SampleWeights + 2);
+				const VectorRegister W3 = VectorLoadFloat1(SampleWeights + 3);
+
+				const VectorRegister X = VectorMultiplyAdd(DX, W3, VectorMultiplyAdd(CX, W2, VectorMultiplyAdd(BX, W1, VectorMultiply(AX, W0))));
+				const VectorRegister Y = VectorMultiplyAdd(DY, W3, VectorMultiplyAdd(CY, W2, VectorMultiplyAdd(BY, W1, VectorMultiply(AY, W0))));
+				const VectorRegister Z = VectorMultiplyAdd(DZ, W3, VectorMultiplyAdd(CZ, W2, VectorMultiplyAdd(BZ, W1, VectorMultiply(AZ, W0))));
+
+				// Dist = DistSquared / Sqrt(DistSquared), clamped so coincident samples add zero instead of NaN
+				const VectorRegister DeltaX = VectorSubtract(X, PrevX);
+				const VectorRegister DeltaY = VectorSubtract(Y, PrevY);
+				const VectorRegister DeltaZ = VectorSubtract(Z, PrevZ);
+				const VectorRegister DistSquared = VectorMultiplyAdd(DeltaZ, DeltaZ, VectorMultiplyAdd(DeltaY, DeltaY, VectorMultiply(DeltaX, DeltaX)));
+				ArcLength = VectorAdd(ArcLength, VectorMultiply(DistSquared, VectorReciprocalSqrtAccurate(VectorMax(DistSquared, MinDistSquared))));
+
+				const int32 Index = Sample * BatchLaneCount;
+				VectorStore(ArcLength, &OutSamples.ArcLengths[Index]);
+				VectorStore(X, &OutSamples.X[Index]);
+				VectorStore(Y, &OutSamples.Y[Index]);
+				VectorStore(Z, &OutSamples.Z[Index]);
+
+				PrevX = X;
+				PrevY = Y;
+				PrevZ = Z;
+			}
+
+			Iterations = VectorAdd(Iterations, VectorBitwiseAnd(Active, VectorOne()));
+			FitHandleHeight = VectorSelect(Active, HandleHeight, FitHandleHeight);
+			FitArcLength = VectorSelect(Active, ArcLength, FitArcLength);
+
+			// Converged lanes keep their height, so later passes resample the same curve for them
+			const VectorRegister Delta = VectorSubtract(ArcLength, TargetArcLength);
+			Active = VectorBitwiseAnd(Active, VectorCompareGE(VectorAbs(Delta), Tolerance));
+
+			// A curve that is too long has too high a handle
+			const VectorRegister TooHigh = VectorCompareGT(Delta, VectorZero());
+			MaxHandleHeight = VectorSelect(Active, VectorSelect(TooHigh, HandleHeight, MaxHandleHeight), MaxHandleHeight);
+			MinHandleHeight = VectorSelect(Active, VectorSelect(TooHigh, MinHandleHeight, HandleHeight), MinHandleHeight);
+			HandleHeight = VectorSelect(Active, VectorMultiply(VectorAdd(MinHandleHeight, MaxHandleHeight), Half), HandleHeight);
+		}
+
+		VectorStore(FitHandleHeight, OutHandleHeights);
+		VectorStore(FitArcLength, OutArcLengths);
+		VectorStore(Iterations, OutIterations);
+	}
+
+	/** Places the links of one lane's chain along its fitted curve, the same way SolveCurveIK does */
+	static void PlaceLane(const FCurveIKBatchChain& Chain, const FBatchLane& Lane, int32 LaneIndex, float HandleHeight,
+	                      const FBatchSamples& Samples, int32 NumPoints, const FCurveIKBatchSettings& Settings)
+	{
+		const FVector Handle1 = Lane.Handle1Start + Lane.Handle1Dir * HandleHeight;
+		const FVector Handle2 = Lane.Handle2Start + Lane.Handle2Dir * HandleHeight;
+		const IKCurveCubicBezier Curve = Settings.CurveType == ECurveIKCurveType::QuadraticBezier
+			? IKCurveCubicBezier(Lane.P1, Handle1, Lane.P2)
+			: IKCurveCubicBezier(Lane.P1, Handle1, Handle2, Lane.P2);
+
+		const float* ArcLengths = Samples.ArcLengths.GetData() + LaneIndex;
+		const float MaxArcLength = ArcLengths[(NumPoints - 1) * BatchLaneCount];
+		const float StepSize = 1.f / (NumPoints - 1);
+
+		float ArcLength = 0.f;
+		int32 Sample = 1;
+		for (FCurveIKChainLink& Link : *Chain.Chain)
+		{
+			ArcLength += Link.Length;
+
+			// Links lie in order along the curve, so each search resumes from the previous link's span
+			while (Sample < NumPoints - 1 && ArcLengths[Sample * BatchLaneCount] < ArcLength)
+			{
+				Sample++;
+			}
+
+			FCurvePoint CurvePoint;
+			CurvePoint.ArcLength = ArcLength;
+			if (ArcLength <= 0.f)
+			{
+				CurvePoint.Point = Samples.GetPoint(0, LaneIndex);
+				CurvePoint.T = 0.f;
+			}
+			else if (ArcLength >= MaxArcLength)
+			{
+				CurvePoint.Point = Samples.GetPoint(NumPoints - 1, LaneIndex);
+				CurvePoint.T = 1.f;
+			}
+			else
+			{
+				const float LeftArcLength = ArcLengths[(Sample - 1) * BatchLaneCount];
+				const float RightArcLength = ArcLengths[Sample * BatchLaneCount];
+				const float PercentThroughGap = (ArcLength - LeftArcLength) / (RightArcLength - LeftArcLength);
+				CurvePoint.Point = FMath::Lerp(Samples.GetPoint(Sample - 1, LaneIndex), Samples.GetPoint(Sample, LaneIndex), PercentThroughGap);
+				CurvePoint.T = (Sample - 1 + PercentThroughGap) * StepSize;
+			}
+			CurvePoint.Tangent = Curve.EvaluateDerivative(CurvePoint.T).GetSafeNormal();
+			CurvePoint.Normal = Curve.EvaluateNormal(CurvePoint.T).GetSafeNormal();
+			Link.CurvePoint = CurvePoint;
+
+			if (Settings.Stretch != 0)
+			{
+				const FVector StretchedBonePosition = Curve.Evaluate(ArcLength / Chain.MaximumReach);
+				Link.Position = FMath::Lerp(CurvePoint.Point, StretchedBonePosition, Settings.Stretch);
+			}
+			else
+			{
+				Link.Position = CurvePoint.Point;
+			}
+		}
+	}
+
+	void SolveCurveIKBatch(TArrayView<const FCurveIKBatchChain> Chains, const FCurveIKBatchSettings& Settings,
+	                       TArrayView<FCurveIKSolveResult> OutResults)
+	{
+		check(OutResults.Num() == Chains.Num());
+
+		const float Weight = FMath::Clamp(Settings.ControlPointWeight, 0.0f, 1.0f);
+		const int32 MaxIterations = FMath::Max(Settings.MaxIterations, 1);
+		const int32 NumPoints = FMath::Max(Settings.NumPointsOnCurve, 2);
+
+		// Out of reach chains take the straight line path, which has nothing to fit
+		TArray<int32, TInlineAllocator<64>> BezierChains;
+		for (int32 ChainIndex = 0; ChainIndex < Chains.Num(); ChainIndex++)
+		{
+			const FCurveIKBatchChain& Chain = Chains[ChainIndex];
+			if (FVector::DistSquared((*Chain.Chain)[0].Position, Chain.TargetLocation) > FMath::Square(Chain.MaximumReach))
+			{
+				OutResults[ChainIndex] = SolveCurveIK(*Chain.Chain, Chain.TargetLocation, Settings.ControlPointWeight,
+				                                      Chain.MaximumReach, MaxIterations, Settings.CurveFitTolerance, NumPoints,
+				                                      Settings.Stretch, nullptr, Settings.HandleAngle, Settings.CurveType);
+			}
+			else
+			{
+				BezierChains.Add(ChainIndex);
+			}
+		}
+
+		if (BezierChains.Num() == 0)
+		{
+			return;
+		}
+
+		// Every lane samples the same parameters, so the control point weights are computed once per batch
+		TArray<float, TInlineAllocator<128>> Weights;
+		Weights.SetNumUninitialized(NumPoints * 4);
+		const float StepSize = 1.f / (NumPoints - 1);
+		for (int32 Sample = 0; Sample < NumPoints; Sample++)
+		{
+			const float T = Sample * StepSize;
+			const float U = 1.f - T;
+			float* SampleWeights = &Weights[Sample * 4];
+			if (Settings.CurveType == ECurveIKCurveType::QuadraticBezier)
+			{
+				SampleWeights[0] = U * U;
+				SampleWeights[1] = 2.f * U * T;
+				SampleWeights[2] = T * T;
+				SampleWeights[3] = 0.f;
+			}
+			else
+			{
+				SampleWeights[0] = U * U * U;
+				SampleWeights[1] = 3.f * U * U * T;
+				SampleWeights[2] = 3.f * U * T * T;
+				SampleWeights[3] = T * T * T;
+			}
+		}
+
+		FBatchSamples Samples;
+		Samples.Init(NumPoints);
+
+		for (int32 GroupStart = 0; GroupStart < BezierChains.Num(); GroupStart += BatchLaneCount)
+		{
+			const int32 NumLanes = FMath::Min(BatchLaneCount, BezierChains.Num() - GroupStart);
+
+			// Spare lanes in the last group repeat its last chain and are masked out of the fit
+			FBatchLane Lanes[BatchLaneCount];
+			for (int32 Lane = 0; Lane < BatchLaneCount; Lane++)
+			{
+				SetupLane(Chains[BezierChains[GroupStart + FMath::Min(Lane, NumLanes - 1)]], Settings, Weight, Lanes[Lane]);
+			}
+
+			float HandleHeights[BatchLaneCount];
+			float ArcLengths[BatchLaneCount];
+			float Iterations[BatchLaneCount];
+			{
+				SCOPE_CYCLE_COUNTER(STAT_CurveIK_Fit);
+				CSV_SCOPED_TIMING_STAT(CurveIK, Fit);
+				FitLanes(Lanes, NumLanes, MaxIterations, Settings.CurveFitTolerance, NumPoints, Weights.GetData(), Samples,
+				         HandleHeights, ArcLengths, Iterations);
+			}
+
+			SCOPE_CYCLE_COUNTER(STAT_CurveIK_Placement);
+			CSV_SCOPED_TIMING_STAT(CurveIK, Placement);
+
+			for (int32 Lane = 0; Lane < NumLanes; Lane++)
+			{
+				const FCurveIKBatchChain& Chain = Chains[BezierChains[GroupStart + Lane]];
+				PlaceLane(Chain, Lanes[Lane], Lane, HandleHeights[Lane], Samples, NumPoints, Settings);
+
+				FCurveIKSolveResult& Result = OutResults[BezierChains[GroupStart + Lane]];
+				Result = FCurveIKSolveResult();
+				Result.Path = ECurveIKSolvePath::Bezier;
+				Result.Iterations = FMath::RoundToInt(Iterations[Lane]);
+				Result.NumCurveSamples = Result.Iterations * NumPoints;
+				Result.ArcLengthResidual = ArcLengths[Lane] - Chain.MaximumReach;
+				Result.bConverged = FMath::Abs(Result.ArcLengthResidual) < Settings.CurveFitTolerance;
+				Result.TipError = FVector::Dist(Chain.Chain->Last().Position, Chain.TargetLocation);
+
+				INC_DWORD_STAT(STAT_CurveIK_Solves);
+				INC_DWORD_STAT_BY(STAT_CurveIK_Iterations, Result.Iterations);
+				INC_DWORD_STAT_BY(STAT_CurveIK_CacheSamples, Result.NumCurveSamples);
+				CSV_CUSTOM_STAT(CurveIK, Solves, 1, ECsvCustomStatOp::Accumulate);
+				CSV_CUSTOM_STAT(CurveIK, Iterations, Result.Iterations, ECsvCustomStatOp::Accumulate);
+				CSV_CUSTOM_STAT(CurveIK, CacheSamples, Result.NumCurveSamples, ECsvCustomStatOp::Accumulate);
+				if (!Result.bConverged)
+				{
+					INC_DWORD_STAT(STAT_CurveIK_NonConverged);
+					CSV_CUSTOM_STAT(CurveIK, NonConverged, 1, ECsvCustomStatOp::Accumulate);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,176 @@
+#include "CurveIKColliders.h"
+#include "Algo/Sort.h"
+
+/** Leaves hold at most this many colliders */
+static const int32 MaxCollidersPerLeaf = 4;
+
+void FCurveIKColliders::AddSphere(const FVector& Center, float Radius)
+{
+	AddCapsule(Center, Center, Radius);
+}
+
+void FCurveIKColliders::AddCapsule(const FVector& Start, const FVector& End, float Radius)
+{
+	Starts.Add(Start);
+	Ends.Add(End);
+	Radii.Add(Radius);
+}
+
+void FCurveIKColliders::Reset()
+{
+	Starts.Reset();
+	Ends.Reset();
+	Radii.Reset();
+	Nodes.Reset();
+	NodeColliders.Reset();
+}
+
+SIZE_T FCurveIKColliders::GetAllocatedSize() const
+{
+	return Starts.GetAllocatedSize() + Ends.GetAllocatedSize() + Radii.GetAllocatedSize()
+		+ Nodes.GetAllocatedSize() + NodeColliders.GetAllocatedSize();
+}
+
+FBox FCurveIKColliders::GetColliderBounds(int32 Collider) const
+{
+	const FVector Extent(Radii[Collider]);
+	FBox Bounds(Starts[Collider] - Extent, Starts[Collider] + Extent);
+	Bounds += FBox(Ends[Collider] - Extent, Ends[Collider] + Extent);
+	return Bounds;
+}
+
+void FCurveIKColliders::Build()
+{
+	Nodes.Reset();
+	NodeColliders.Reset(Num());
+	for (int32 Collider = 0; Collider < Num(); Collider++)
+	{
+		NodeColliders.Add(Collider);
+	}
+
+	if (Num() > 0)
+	{
+		Nodes.AddUninitialized();
+		BuildNode(0, 0, Num());
+	}
+}
+
+void FCurveIKColliders::MoveCapsule(int32 Collider, const FVector& Start, const FVector& End)
+{
+	Starts[Collider] = Start;
+	Ends[Collider] = End;
+}
+
+void FCurveIKColliders::Refit()
+{
+	// Children always follow their parent, so walking the nodes backwards refits both children before their parent
+	for (int32 NodeIndex = Nodes.Num() - 1; NodeIndex >= 0; NodeIndex--)
+	{
+		FNode& Node = Nodes[NodeIndex];
+		if (Node.FirstChild != INDEX_NONE)
+		{
+			Node.Bounds = Nodes[Node.FirstChild].Bounds + Nodes[Node.FirstChild + 1].Bounds;
+			continue;
+		}
+
+		FBox Bounds(ForceInit);
+		for (int32 Index = Node.FirstCollider; Index < Node.FirstCollider + Node.NumColliders; Index++)
+		{
+			Bounds += GetColliderBounds(NodeColliders[Index]);
+		}
+		Node.Bounds = Bounds;
+	}
+}
+
+void FCurveIKColliders::BuildNode(int32 NodeIndex, int32 FirstCollider, int32 NumColliders)
+{
+	FBox Bounds(ForceInit);
+	for (int32 Index = FirstCollider; Index < FirstCollider + NumColliders; Index++)
+	{
+		Bounds += GetColliderBounds(NodeColliders[Index]);
+	}
+
+	Nodes[NodeIndex].Bounds = Bounds;
+	Nodes[NodeIndex].FirstChild = INDEX_NONE;
+	Nodes[NodeIndex].FirstCollider = FirstCollider;
+	Nodes[NodeIndex].NumColliders = NumColliders;
+
+	if (NumColliders <= MaxCollidersPerLeaf)
+	{
+		return;
+	}
+
+	// Split at the median collider along the longest axis of the node
+	const FVector Size = Bounds.GetSize();
+	const int32 Axis = Size.X >= Size.Y && Size.X >= Size.Z ? 0 : (Size.Y >= Size.Z ? 1 : 2);
+	int32* Colliders = NodeColliders.GetData() + FirstCollider;
+	Algo::Sort(TArrayView<int32>(Colliders, NumColliders), [this, Axis](int32 A, int32 B)
+	{
+		return (Starts[A][Axis] + Ends[A][Axis]) < (Starts[B][Axis] + Ends[B][Axis]);
+	});
+
+	const int32 FirstChild = Nodes.Num();
+	const int32 NumLeft = NumColliders / 2;
+	Nodes[NodeIndex].FirstChild = FirstChild;
+	Nodes.AddUninitialized(2);
+	BuildNode(FirstChild, FirstCollider, NumLeft);
+	BuildNode(FirstChild + 1, FirstCollider + NumLeft, NumColliders - NumLeft);
+}
+
+void FCurveIKColliders::Overlap(const FSphere& Sphere, TArray<int32, TInlineAllocator<16>>& OutColliders) const
+{
+	OutColliders.Reset();
+	if (Nodes.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<int32, TInlineAllocator<32>> Stack;
+	Stack.Add(0);
+	while (Stack.Num() > 0)
+	{
+		const FNode& Node = Nodes[Stack.Pop(false)];
+		if (!FMath::SphereAABBIntersection(Sphere, Node.Bounds))
+		{
+			continue;
+		}
+
+		if (Node.FirstChild != INDEX_NONE)
+		{
+			Stack.Add(Node.FirstChild);
+			Stack.Add(Node.FirstChild + 1);
+			continue;
+		}
+
+		for (int32 Index = Node.FirstCollider; Index < Node.FirstCollider + Node.NumColliders; Index++)
+		{
+			const int32 Collider = NodeColliders[Index];
+			if (FMath::SphereAABBIntersection(Sphere, GetColliderBounds(Collider)))
+			{
+				OutColliders.Add(Collider);
+			}
+		}
+	}
+}
+
+bool FCurveIKColliders::Contains(int32 Collider, const FVector& Point) const
+{
+	const FVector Closest = FMath::ClosestPointOnSegment(Point, Starts[Collider], Ends[Collider]);
+	return FVector::DistSquared(Point, Closest) < FMath::Square(Radii[Collider]);
+}
+
+float FCurveIKColliders::GetPenetration(const FVector& Point, const TArray<int32, TInlineAllocator<16>>& Colliders, float Inflate) const
+{
+	float MaxPenetration = 0.f;
+	for (const int32 Collider : Colliders)
+	{
+		const FVector Closest = FMath::ClosestPointOnSegment(Point, Starts[Collider], Ends[Collider]);
+		const float Radius = Radii[Collider] + Inflate;
+		const float DistSquared = FVector::DistSquared(Point, Closest);
+		if (DistSquared < FMath::Square(Radius))
+		{
+			MaxPenetration = FMath::Max(MaxPenetration, Radius - FMath::Sqrt(DistSquared));
+		}
+	}
+	return MaxPenetration;
+}
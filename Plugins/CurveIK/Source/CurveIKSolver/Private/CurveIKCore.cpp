@@ -0,0 +1,320 @@
+#include "CurveIKCore.h"
+#include "CurveCache.h"
+#include "CurveIKColliders.h"
+#include "CurveIKCorePrivate.h"
+#include "CurveIKHeightCurve.h"
+#include "CurveIKSharedCurveCache.h"
+#include "CurveIKStats.h"
+#include "IKCurves/IKCurveBezier.h"
+#include "IKCurves/IKCurveCubicBezier.h"
+#include "IKCurves/IKCurveLine.h"
+#include "IKCurves/IKCurveSharedBezier.h"
+
+namespace CurveIK_AnimationCore
+{
+	
+	FVector GetReferenceNormal(const FVector P1, const FVector P2, const FVector ComponentUpVector)
+	{
+		const FVector P_ = (P2 - P1).GetSafeNormal();
+		const FVector V = FVector::DownVector - P_;
+		
+		return -1 * FVector::VectorPlaneProject(V, P_).GetSafeNormal();
+	}
+
+	/** Rotations in degrees of the handle direction about the chord tried when a curve penetrates a collider, nearest first */
+	static const float CollisionHandleRotations[] = { 45.f, -45.f, 90.f, -90.f, 135.f, -135.f, 180.f };
+
+	/**
+	 * The cached samples of a fitted bezier curve and the transform that places them. Curves from the shared cache are
+	 * not copied, so their samples are still in the cache's canonical space.
+	 */
+	static const FCurveIK_CurveCache& GetCurveSamples(const IKCurve& Bezier, bool bSharedCurve, FTransform& OutTransform)
+	{
+		if (bSharedCurve)
+		{
+			const IKCurveSharedBezier& SharedBezier = static_cast<const IKCurveSharedBezier&>(Bezier);
+			OutTransform = SharedBezier.GetTransform();
+			return SharedBezier.GetCurve().CurveCache;
+		}
+
+		OutTransform = FTransform::Identity;
+		return static_cast<const IKCurveCubicBezier&>(Bezier).CurveCache;
+	}
+
+	/** Deepest penetration of the curve's cached samples into the given colliders */
+	static float GetCurvePenetration(const IKCurve& Curve, bool bSharedCurve, const FCurveIKColliders& Colliders,
+	                                 const TArray<int32, TInlineAllocator<16>>& Candidates, float CollisionRadius)
+	{
+		FTransform SamplesToComponent;
+		const FCurveIK_CurveCache& Samples = GetCurveSamples(Curve, bSharedCurve, SamplesToComponent);
+
+		float MaxPenetration = 0.f;
+		for (const FCurvePoint& CurvePoint : Samples.GetCurvePoints())
+		{
+			const FVector Point = SamplesToComponent.TransformPosition(CurvePoint.Point);
+			MaxPenetration = FMath::Max(MaxPenetration, Colliders.GetPenetration(Point, Candidates, CollisionRadius));
+		}
+		return MaxPenetration;
+	}
+
+	// Implementation of the curve IK algorithm
+	FCurveIKSolveResult SolveCurveIK(TArray<FCurveIKChainLink>& InOutChain, const FVector& TargetPosition, float ControlPointWeight,
+	                                 float MaximumReach, int MaxIterations, float CurveFitTolerance, int NumPointsOnCurve, float Stretch,
+	                                 FCurveIKDebugData* CurveIKDebugData, float HandleAngle, ECurveIKCurveType CurveType,
+	                                 float MaxCurveError, bool bUseSharedCurveCache,
+	                                 const FCurveIKColliders* Colliders, float CollisionRadius,
+	                                 const FCurveIKHeightCurve* HeightCurve)
+	{
+		float const RootToTargetDistSq = FVector::DistSquared(InOutChain[0].Position, TargetPosition);
+		int32 const NumChainLinks = InOutChain.Num();
+		FVector const RightVector = FVector::RightVector;
+		FVector const UpVector = FVector::UpVector;
+
+		FVector const P1 = InOutChain[0].Position;
+		FVector const P2 = TargetPosition;
+		FVector HandleDir = GetReferenceNormal(P1, P2, UpVector);
+		TArray<FVector, TInlineAllocator<4>> ControlPoints;
+		
+		float ArcLength = 0;
+		const float Weight = FMath::Clamp(ControlPointWeight, 0.0f, 1.0f);
+		// Shared cache curves refer to the cached curve instead of owning their own
+		const bool bSharedCurves = bUseSharedCurveCache && !HeightCurve;
+		TUniquePtr<IKCurve> Curve;
+		FCurveIKSolveResult Result;
+
+		INC_DWORD_STAT(STAT_CurveIK_Solves);
+		CSV_CUSTOM_STAT(CurveIK, Solves, 1, ECsvCustomStatOp::Accumulate);
+
+		{
+			SCOPE_CYCLE_COUNTER(STAT_CurveIK_Fit);
+			CSV_SCOPED_TIMING_STAT(CurveIK, Fit);
+
+			if (RootToTargetDistSq > FMath::Square(MaximumReach))
+			{
+				// A straight line is exactly as long as the chain, so there is nothing to fit
+				Curve.Reset(IKCurveLine::FindCurve(P1, P2, HandleDir, MaximumReach));
+				Result.Path = ECurveIKSolvePath::Line;
+				Result.bConverged = true;
+			}
+			else
+			{
+				if (CurveType == ECurveIKCurveType::QuadraticBezier) { ControlPoints.SetNum(3); }
+				else { ControlPoints.SetNum(4); }
+
+				// Fits a curve bending towards FitHandleDir and adds its cost to the result
+				auto FitBezier = [&](const FVector& FitHandleDir, TArray<FVector, TInlineAllocator<4>>& FitControlPoints, bool& bOutCacheHit)
+				{
+					int FitIterations = 0;
+					int FitNumSamples = 0;
+					IKCurve* Bezier;
+					if (HeightCurve)
+					{
+						float HandleHeight;
+						float ArcLengthSlope;
+						HeightCurve->Evaluate(FVector::Dist(P1, P2), HandleHeight, ArcLengthSlope);
+						Bezier = IKCurveCubicBezier::RefineCurve(P1, P2, FitHandleDir, Weight, MaximumReach, HandleHeight, ArcLengthSlope,
+						                                         MaxIterations, CurveFitTolerance, NumPointsOnCurve, FitControlPoints, HandleAngle, CurveType,
+						                                         MaxCurveError, FitIterations, FitNumSamples);
+						bOutCacheHit = false;
+					}
+					else if (bUseSharedCurveCache)
+					{
+						Bezier = FCurveIKSharedCurveCache::Get().FindCurve(P1, P2, FitHandleDir, Weight, MaximumReach, MaxIterations,
+						                                                   CurveFitTolerance, NumPointsOnCurve, FitControlPoints, HandleAngle,
+						                                                   CurveType, MaxCurveError, FitIterations, FitNumSamples, bOutCacheHit);
+					}
+					else
+					{
+						Bezier = IKCurveCubicBezier::FindCurve(P1, P2, FitHandleDir, Weight, MaximumReach, MaxIterations,
+						                                       CurveFitTolerance, NumPointsOnCurve, FitControlPoints, HandleAngle, CurveType,
+						                                       MaxCurveError, FitIterations, FitNumSamples);
+						bOutCacheHit = false;
+					}
+					Result.Iterations += FitIterations;
+					Result.NumCurveSamples += FitNumSamples;
+					return TUniquePtr<IKCurve>(Bezier);
+				};
+
+				TUniquePtr<IKCurve> Bezier = FitBezier(HandleDir, ControlPoints, Result.bSharedCacheHit);
+				if (!Bezier)
+				{
+					// No curve was evaluated, such as with MaxIterations below one, so the chain is laid straight instead
+					Curve.Reset(IKCurveLine::FindCurve(P1, P2, HandleDir, MaximumReach));
+					Result.Path = ECurveIKSolvePath::Line;
+					ControlPoints.Reset();
+				}
+				else if (Colliders && Colliders->Num() > 0)
+				{
+					SCOPE_CYCLE_COUNTER(STAT_CurveIK_Collision);
+
+					// A curve of the chain's length from P1 to P2 never strays further than half that length from their midpoint
+					const FSphere ChainBounds((P1 + P2) * 0.5f, MaximumReach * 0.5f + CollisionRadius);
+					TArray<int32, TInlineAllocator<16>> Candidates;
+					Colliders->Overlap(ChainBounds, Candidates);
+
+					// The curve has to start at the root and end at the target, so it cannot leave colliders around them
+					Candidates.RemoveAll([Colliders, &P1, &P2](int32 Collider)
+					{
+						return Colliders->Contains(Collider, P1) || Colliders->Contains(Collider, P2);
+					});
+
+					if (Candidates.Num() > 0)
+					{
+						const FVector ChordDir = (P2 - P1).GetSafeNormal();
+						const FVector ReferenceHandleDir = HandleDir;
+						float Penetration = GetCurvePenetration(*Bezier, bSharedCurves, *Colliders, Candidates, CollisionRadius);
+
+						for (const float Rotation : CollisionHandleRotations)
+						{
+							if (Penetration <= 0.f)
+							{
+								break;
+							}
+
+							const FVector RotatedHandleDir = ReferenceHandleDir.RotateAngleAxis(Rotation, ChordDir);
+							TArray<FVector, TInlineAllocator<4>> RotatedControlPoints;
+							RotatedControlPoints.SetNum(ControlPoints.Num());
+							bool bRotatedCacheHit = false;
+							TUniquePtr<IKCurve> RotatedBezier = FitBezier(RotatedHandleDir, RotatedControlPoints, bRotatedCacheHit);
+							Result.CollisionRefits++;
+							if (!RotatedBezier)
+							{
+								continue;
+							}
+
+							const float RotatedPenetration = GetCurvePenetration(*RotatedBezier, bSharedCurves, *Colliders, Candidates, CollisionRadius);
+							if (RotatedPenetration < Penetration)
+							{
+								Bezier = MoveTemp(RotatedBezier);
+								ControlPoints = RotatedControlPoints;
+								HandleDir = RotatedHandleDir;
+								Result.bSharedCacheHit = bRotatedCacheHit;
+								Penetration = RotatedPenetration;
+							}
+						}
+
+						Result.CollisionPenetration = Penetration;
+					}
+				}
+
+				if (Bezier)
+				{
+					Curve = MoveTemp(Bezier);
+					Result.Path = ECurveIKSolvePath::Bezier;
+					Result.ArcLengthResidual = Curve->ArcLength - MaximumReach;
+					Result.bConverged = FMath::Abs(Result.ArcLengthResidual) < CurveFitTolerance;
+				}
+			}
+		}
+
+		INC_DWORD_STAT_BY(STAT_CurveIK_Iterations, Result.Iterations);
+		CSV_CUSTOM_STAT(CurveIK, Iterations, Result.Iterations, ECsvCustomStatOp::Accumulate);
+		if (!Result.bConverged)
+		{
+			INC_DWORD_STAT(STAT_CurveIK_NonConverged);
+			CSV_CUSTOM_STAT(CurveIK, NonConverged, 1, ECsvCustomStatOp::Accumulate);
+		}
+
+		{
+			SCOPE_CYCLE_COUNTER(STAT_CurveIK_Placement);
+			CSV_SCOPED_TIMING_STAT(CurveIK, Placement);
+
+			for (int LinkIndex = 0; LinkIndex < NumChainLinks; LinkIndex++)
+			{
+				FCurveIKChainLink& CurrentLink = InOutChain[LinkIndex];
+				ArcLength += CurrentLink.Length;
+
+				const FCurvePoint CurvePoint = Curve->Approximate(ArcLength);
+				const FVector BonePosition = CurvePoint.Point;
+				CurrentLink.CurvePoint = CurvePoint;
+
+				if (Stretch != 0)
+				{
+					const float T = ArcLength / MaximumReach;
+					const FVector StretchedBonePosition = Curve->Evaluate(T);
+					CurrentLink.Position = FMath::Lerp(BonePosition, StretchedBonePosition, Stretch);
+				} else
+				{
+					CurrentLink.Position = BonePosition;
+				}
+			}
+		}
+
+		// Out of reach targets can only be approached as far as the chain extends
+		const FVector ReachableTarget = Result.Path == ECurveIKSolvePath::Line
+			? P1 + (P2 - P1).GetSafeNormal() * MaximumReach
+			: P2;
+		Result.TipError = FVector::Dist(InOutChain.Last().Position, ReachableTarget);
+
+		if (CurveIKDebugData)
+		{
+			CurveIKDebugData->ControlPoints.Reset();
+			CurveIKDebugData->ControlPoints.Append(ControlPoints);
+			CurveIKDebugData->RightVector = RightVector;
+			CurveIKDebugData->UpVector = UpVector;
+			CurveIKDebugData->HandleDir = HandleDir;
+			CurveIKDebugData->P1 = P1;
+			CurveIKDebugData->P2 = P2;
+
+			if (Result.Path == ECurveIKSolvePath::Bezier)
+			{
+				FTransform SamplesToComponent;
+				CurveIKDebugData->CurveCache = GetCurveSamples(*Curve, bSharedCurves, SamplesToComponent);
+				if (bSharedCurves)
+				{
+					CurveIKDebugData->CurveCache.Transform(SamplesToComponent);
+				}
+			}
+			else
+			{
+				CurveIKDebugData->CurveCache.Empty();
+			}
+		}
+
+		return Result;
+	}
+
+	FQuat OrientLinkBone(const FQuat& BoneRotation, const FVector& OldDir, const FVector& NewDir,
+	                     const FVector& CurveNormal, FQuat& OutSwing)
+	{
+		// Calculate axis of rotation from pre-translation vector to post-translation vector
+		FVector const RotationAxis = FVector::CrossProduct(OldDir, NewDir).GetSafeNormal();
+		float const RotationAngle = FMath::Acos(FMath::Clamp(FVector::DotProduct(OldDir, NewDir), -1.f, 1.f));
+		OutSwing = FQuat(RotationAxis, RotationAngle);
+		// We're going to multiply it, in order to not have to re-normalize the final quaternion, it has to be a unit quaternion.
+		checkSlow(OutSwing.IsNormalized());
+
+		FQuat Rotation = OutSwing * BoneRotation;
+		Rotation.Normalize();
+
+		// Correct the bone roll
+		FVector const OldBoneRollDir = Rotation.GetUpVector() * -1.f;
+		FVector const NewBoneRollDir = FVector::VectorPlaneProject(CurveNormal, NewDir);
+		Rotation = FQuat::FindBetweenVectors(OldBoneRollDir, NewBoneRollDir) * Rotation;
+		Rotation.Normalize();
+
+		return Rotation;
+	}
+
+	float GetBoneRoll(const FQuat& From, const FQuat& To, const FVector& BoneAxis)
+	{
+		FQuat Swing;
+		FQuat Twist;
+		(From.Inverse() * To).ToSwingTwist(BoneAxis, Swing, Twist);
+
+		// The twist's axis is BoneAxis or its opposite, which flips the sign of the angle
+		const float Sign = FVector::DotProduct(Twist.GetRotationAxis(), BoneAxis) < 0.f ? -1.f : 1.f;
+		return FRotator::NormalizeAxis(FMath::RadiansToDegrees(Sign * Twist.GetAngle()));
+	}
+
+	void GetSolvedBoneRotations(const TArray<FCurveIKChainLink>& Links, TArray<FQuat>& OutRotations)
+	{
+		OutRotations.Reset(Links.Num());
+		for (int32 LinkIndex = 0; LinkIndex < Links.Num() - 1; LinkIndex++)
+		{
+			const FVector NewDir = (Links[LinkIndex + 1].Position - Links[LinkIndex].Position).GetSafeNormal();
+			FQuat Swing;
+			OutRotations.Add(OrientLinkBone(FQuat::Identity, FVector::ForwardVector, NewDir, Links[LinkIndex].CurvePoint.Normal, Swing));
+		}
+	}
+};
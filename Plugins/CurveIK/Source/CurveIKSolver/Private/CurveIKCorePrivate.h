@@ -0,0 +1,19 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Helpers shared by the scalar and batched solvers */
+namespace CurveIK_AnimationCore
+{
+	/**
+	 * Computes a stable direction vector normal to the direction of ik target and
+	 * relative to the component's transform
+	 * 
+	 * @param P1 The position of the root bone
+	 * @param P2 The position of the tip bone
+	 * @param ComponentUpVector The up vector of the component to which this IK system applies
+	 * 
+	 * @return A stable vector normal to P1 and P2
+	 */
+	FVector GetReferenceNormal(const FVector P1, const FVector P2, const FVector ComponentUpVector);
+}
@@ -0,0 +1,69 @@
+#include "CurveIKHeightCurve.h"
+#include "IKCurves/IKCurveCubicBezier.h"
+
+bool FCurveIKHeightCurve::FSettings::operator==(const FSettings& Other) const
+{
+	return MaximumReach == Other.MaximumReach
+		&& ControlPointWeight == Other.ControlPointWeight
+		&& MaxIterations == Other.MaxIterations
+		&& CurveFitTolerance == Other.CurveFitTolerance
+		&& NumPointsOnCurve == Other.NumPointsOnCurve
+		&& HandleAngle == Other.HandleAngle
+		&& MaxCurveError == Other.MaxCurveError
+		&& CurveType == Other.CurveType;
+}
+
+FCurveIKHeightCurve::FCurveIKHeightCurve(const FSettings& InSettings)
+	: Settings(InSettings)
+	, KeySpacing(InSettings.MaximumReach / (NumKeys - 1))
+{
+	const float Weight = FMath::Clamp(Settings.ControlPointWeight, 0.0f, 1.0f);
+	const int32 NumControlPoints = Settings.CurveType == ECurveIKCurveType::QuadraticBezier ? 3 : 4;
+
+	// Arc-length does not depend on where the chord is or which way the handles point, so every key is fitted along X
+	const FVector HandleDir = FVector::UpVector;
+
+	HandleHeights.SetNumUninitialized(NumKeys);
+	ArcLengthSlopes.SetNumUninitialized(NumKeys);
+	for (int32 Key = 0; Key < NumKeys; Key++)
+	{
+		const FVector P2(Key * KeySpacing, 0.f, 0.f);
+		TArray<FVector, TInlineAllocator<4>> ControlPoints;
+		ControlPoints.SetNum(NumControlPoints);
+		int Iterations = 0;
+		int NumSamples = 0;
+		float HandleHeight = 0.f;
+		delete IKCurveCubicBezier::FindCurve(FVector::ZeroVector, P2, HandleDir, Weight, Settings.MaximumReach, Settings.MaxIterations,
+		                                     Settings.CurveFitTolerance, Settings.NumPointsOnCurve, ControlPoints, Settings.HandleAngle,
+		                                     Settings.CurveType, Settings.MaxCurveError, Iterations, NumSamples, &HandleHeight);
+
+		// Central difference around the fitted height, for the runtime's refinement step
+		const float HeightStep = FMath::Max(HandleHeight * 0.01f, 0.01f);
+		const float LowerHeight = FMath::Max(HandleHeight - HeightStep, 0.f);
+		const float UpperHeight = HandleHeight + HeightStep;
+		TUniquePtr<IKCurveCubicBezier> Lower(IKCurveCubicBezier::MakeCurve(FVector::ZeroVector, P2, HandleDir, Weight, LowerHeight,
+		                                                                   Settings.HandleAngle, Settings.CurveType));
+		TUniquePtr<IKCurveCubicBezier> Upper(IKCurveCubicBezier::MakeCurve(FVector::ZeroVector, P2, HandleDir, Weight, UpperHeight,
+		                                                                   Settings.HandleAngle, Settings.CurveType));
+		Lower->EvaluateForFit(Settings.NumPointsOnCurve, Settings.MaxCurveError);
+		Upper->EvaluateForFit(Settings.NumPointsOnCurve, Settings.MaxCurveError);
+
+		HandleHeights[Key] = HandleHeight;
+		ArcLengthSlopes[Key] = (Upper->ArcLength - Lower->ArcLength) / (UpperHeight - LowerHeight);
+	}
+}
+
+void FCurveIKHeightCurve::Evaluate(float Distance, float& OutHandleHeight, float& OutArcLengthSlope) const
+{
+	const float KeyPosition = KeySpacing > 0.f ? FMath::Clamp(Distance / KeySpacing, 0.f, float(NumKeys - 1)) : 0.f;
+	const int32 Key = FMath::Min(FMath::FloorToInt(KeyPosition), NumKeys - 2);
+	const float Alpha = KeyPosition - Key;
+
+	// Catmull-Rom through the neighbouring keys, repeating the end keys past either end
+	const float H0 = HandleHeights[FMath::Max(Key - 1, 0)];
+	const float H1 = HandleHeights[Key];
+	const float H2 = HandleHeights[Key + 1];
+	const float H3 = HandleHeights[FMath::Min(Key + 2, NumKeys - 1)];
+	OutHandleHeight = FMath::Max(FMath::CubicInterp(H1, 0.5f * (H2 - H0), H2, 0.5f * (H3 - H1), Alpha), 0.f);
+	OutArcLengthSlope = FMath::Lerp(ArcLengthSlopes[Key], ArcLengthSlopes[Key + 1], Alpha);
+}
@@ -0,0 +1,172 @@
+#include "CurveIKSharedCurveCache.h"
+#include "CurveIKStats.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeRWLock.h"
+
+/** Reach of the chain in canonical space. The fit is scale invariant, so this only keeps canonical distances near those of a typical chain. */
+static const float CanonicalReach = 100.f;
+
+static TAutoConsoleVariable<int32> CVarCurveIKSharedCurveCacheMaxCurves(
+	TEXT("CurveIK.SharedCurveCache.MaxCurves"),
+	65536,
+	TEXT("Number of curves the CurveIK shared curve cache holds. When it is full, the least recently used curves are evicted."),
+	ECVF_Default);
+
+bool FCurveIKSharedCurveCache::FKey::operator==(const FKey& Other) const
+{
+	return ChordRatioIndex == Other.ChordRatioIndex
+		&& HandleWeight == Other.HandleWeight
+		&& HandleAngle == Other.HandleAngle
+		&& CurveFitTolerance == Other.CurveFitTolerance
+		&& MaxCurveError == Other.MaxCurveError
+		&& MaxIterations == Other.MaxIterations
+		&& NumPoints == Other.NumPoints
+		&& CurveType == Other.CurveType;
+}
+
+FCurveIKSharedCurveCache& FCurveIKSharedCurveCache::Get()
+{
+	static FCurveIKSharedCurveCache Instance;
+	return Instance;
+}
+
+IKCurveSharedBezier* FCurveIKSharedCurveCache::FindCurve(FVector P1, FVector P2, FVector HandleDir, float HandleWeight,
+                                                        float TargetArcLength, int MaxIterations, float CurveFitTolerance,
+                                                        int NumPoints, TArray<FVector, TInlineAllocator<4>>& ControlPoints,
+                                                        float HandleAngle, ECurveIKCurveType CurveType, float MaxCurveError,
+                                                        int& OutIterations, int& OutNumSamples, bool& bOutCacheHit)
+{
+	const FVector Chord = P2 - P1;
+	const float ChordLength = Chord.Size();
+	const float RelativeTolerance = TargetArcLength > 0 ? CurveFitTolerance / TargetArcLength : 0;
+
+	bOutCacheHit = false;
+	if (ChordLength < KINDA_SMALL_NUMBER || RelativeTolerance <= 0 || RelativeTolerance >= 1)
+	{
+		// Not cached, but returned the same way so callers handle one kind of curve
+		IKCurveCubicBezier* Curve = IKCurveCubicBezier::FindCurve(P1, P2, HandleDir, HandleWeight, TargetArcLength, MaxIterations,
+		                                                          CurveFitTolerance, NumPoints, ControlPoints, HandleAngle, CurveType,
+		                                                          MaxCurveError, OutIterations, OutNumSamples);
+		return Curve ? new IKCurveSharedBezier(TSharedRef<const IKCurveCubicBezier, ESPMode::ThreadSafe>(Curve), FTransform::Identity) : nullptr;
+	}
+
+	// Half of the tolerance is spent on quantizing the chord ratio and half on fitting the canonical curve.
+	// Log spaced buckets keep the relative arc-length error from quantization below half the relative tolerance.
+	const float LogStep = FMath::Loge(1.f + RelativeTolerance);
+	const int32 ChordRatioIndex = FMath::RoundToInt(FMath::Loge(ChordLength / TargetArcLength) / LogStep);
+	const float QuantizedChordRatio = FMath::Exp(ChordRatioIndex * LogStep);
+
+	FKey Key;
+	Key.ChordRatioIndex = ChordRatioIndex;
+	Key.HandleWeight = HandleWeight;
+	Key.HandleAngle = HandleAngle;
+	Key.CurveFitTolerance = RelativeTolerance;
+	Key.MaxCurveError = MaxCurveError / TargetArcLength;
+	Key.MaxIterations = MaxIterations;
+	Key.NumPoints = NumPoints;
+	Key.CurveType = CurveType;
+
+	TSharedPtr<const IKCurveCubicBezier, ESPMode::ThreadSafe> Curve;
+	{
+		FRWScopeLock ReadLock(Lock, SLT_ReadOnly);
+		if (FEntry* Entry = Curves.Find(Key))
+		{
+			Curve = Entry->Curve;
+			FPlatformAtomics::InterlockedExchange(&Entry->LastUsed, ++UseClock);
+		}
+	}
+
+	if (Curve.IsValid())
+	{
+		bOutCacheHit = true;
+		OutIterations = 0;
+		OutNumSamples = 0;
+		INC_DWORD_STAT(STAT_CurveIK_SharedCacheHits);
+	}
+	else
+	{
+		IKCurveCubicBezier* FittedCurve = IKCurveCubicBezier::FindCurve(FVector::ZeroVector, FVector(QuantizedChordRatio * CanonicalReach, 0.f, 0.f),
+		                                                                FVector::UpVector, HandleWeight, CanonicalReach, MaxIterations,
+		                                                                0.5f * RelativeTolerance * CanonicalReach, NumPoints, ControlPoints, HandleAngle,
+		                                                                CurveType, Key.MaxCurveError * CanonicalReach, OutIterations, OutNumSamples);
+		INC_DWORD_STAT(STAT_CurveIK_SharedCacheMisses);
+		if (!FittedCurve)
+		{
+			return nullptr;
+		}
+
+		FRWScopeLock WriteLock(Lock, SLT_Write);
+		if (const FEntry* Entry = Curves.Find(Key))
+		{
+			// Another thread fitted the same curve first
+			Curve = Entry->Curve;
+			delete FittedCurve;
+		}
+		else
+		{
+			EvictLeastRecentlyUsed(FMath::Max(CVarCurveIKSharedCurveCacheMaxCurves.GetValueOnAnyThread(), 1));
+			const TSharedRef<const IKCurveCubicBezier, ESPMode::ThreadSafe> SharedCurve(FittedCurve);
+			Curves.Add(Key, FEntry{ SharedCurve, ++UseClock });
+			Curve = SharedCurve;
+		}
+	}
+
+	// Canonical X maps onto the chord and canonical Z onto HandleDir, which is always normal to the chord
+	const float Scale = ChordLength / (QuantizedChordRatio * CanonicalReach);
+	const FTransform CanonicalToComponent(FRotationMatrix::MakeFromXZ(Chord, HandleDir).ToQuat(), P1, FVector(Scale));
+	IKCurveSharedBezier* PlacedCurve = new IKCurveSharedBezier(Curve.ToSharedRef(), CanonicalToComponent);
+	PlacedCurve->GetControlPoints(ControlPoints);
+
+	return PlacedCurve;
+}
+
+void FCurveIKSharedCurveCache::EvictLeastRecentlyUsed(int32 MaxCurves)
+{
+	if (Curves.Num() < MaxCurves)
+	{
+		return;
+	}
+
+	// Evicting an eighth of the capacity at once spreads the cost of finding the oldest curves over many misses
+	const int32 NumToEvict = FMath::Min(Curves.Num() - MaxCurves + 1 + MaxCurves / 8, Curves.Num());
+
+	TArray<int64> LastUsed;
+	LastUsed.Reserve(Curves.Num());
+	for (const TPair<FKey, FEntry>& Pair : Curves)
+	{
+		LastUsed.Add(Pair.Value.LastUsed);
+	}
+	LastUsed.Sort();
+
+	const int64 NewestEvicted = LastUsed[NumToEvict - 1];
+	for (TMap<FKey, FEntry>::TIterator It = Curves.CreateIterator(); It; ++It)
+	{
+		if (It.Value().LastUsed <= NewestEvicted)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FCurveIKSharedCurveCache::Empty()
+{
+	FRWScopeLock WriteLock(Lock, SLT_Write);
+	Curves.Empty();
+}
+
+int32 FCurveIKSharedCurveCache::Num() const
+{
+	FRWScopeLock ReadLock(Lock, SLT_ReadOnly);
+	return Curves.Num();
+}
+
+SIZE_T FCurveIKSharedCurveCache::GetAllocatedSize() const
+{
+	FRWScopeLock ReadLock(Lock, SLT_ReadOnly);
+	SIZE_T Size = Curves.GetAllocatedSize();
+	for (const TPair<FKey, FEntry>& Pair : Curves)
+	{
+		Size += sizeof(IKCurveCubicBezier) + Pair.Value.Curve->CurveCache.GetAllocatedSize();
+	}
+	return Size;
+}
@@ -0,0 +1,19 @@
+#include "CoreMinimal.h"
+#include "Modules/ModuleManager.h"
+#include "CurveIKStats.h"
+
+DEFINE_STAT(STAT_CurveIK_Fit);
+DEFINE_STAT(STAT_CurveIK_Sampling);
+DEFINE_STAT(STAT_CurveIK_Collision);
+DEFINE_STAT(STAT_CurveIK_Placement);
+DEFINE_STAT(STAT_CurveIK_Rotation);
+DEFINE_STAT(STAT_CurveIK_Solves);
+DEFINE_STAT(STAT_CurveIK_Iterations);
+DEFINE_STAT(STAT_CurveIK_CacheSamples);
+DEFINE_STAT(STAT_CurveIK_NonConverged);
+DEFINE_STAT(STAT_CurveIK_SharedCacheHits);
+DEFINE_STAT(STAT_CurveIK_SharedCacheMisses);
+
+CSV_DEFINE_CATEGORY_MODULE(CURVEIKSOLVER_API, CurveIK, true);
+
+IMPLEMENT_MODULE(FDefaultModuleImpl, CurveIKSolver)
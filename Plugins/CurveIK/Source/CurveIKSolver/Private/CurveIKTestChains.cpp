@@ -0,0 +1,33 @@
+#include "CurveIKTestChains.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace CurveIK_AnimationCore
+{
+	FCurveIKTestChain MakeRandomChain(FRandomStream& Random, const FVector& Root, int32 MinLinks, int32 MaxLinks,
+	                                  float MinLength, float MaxLength)
+	{
+		FCurveIKTestChain Chain;
+		const int32 NumLinks = Random.RandRange(MinLinks, MaxLinks);
+
+		Chain.Links.Reserve(NumLinks);
+		Chain.Links.Add(FCurveIKChainLink(Root, 0.f, 0, 0));
+		for (int32 LinkIndex = 1; LinkIndex < NumLinks; LinkIndex++)
+		{
+			const float Length = Random.FRandRange(MinLength, MaxLength);
+			Chain.MaximumReach += Length;
+			Chain.Links.Add(FCurveIKChainLink(Root + FVector(Chain.MaximumReach, 0.f, 0.f), Length, LinkIndex, LinkIndex));
+		}
+
+		return Chain;
+	}
+
+	FVector GetRandomTarget(FRandomStream& Random, const FCurveIKTestChain& Chain, float MinReach, float MaxReach)
+	{
+		const FVector TargetDir = Random.GetUnitVector();
+		const float TargetDist = Chain.MaximumReach * Random.FRandRange(MinReach, MaxReach);
+		return Chain.Links[0].Position + TargetDir * TargetDist;
+	}
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
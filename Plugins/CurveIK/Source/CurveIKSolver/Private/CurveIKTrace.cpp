@@ -0,0 +1,380 @@
+#include "CurveIKTrace.h"
+#include "CurveIKSharedCurveCache.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/ScopeRWLock.h"
+#include "Serialization/MemoryWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCurveIKTrace, Log, All);
+
+static FAutoConsoleCommand CurveIKTraceStartCommand(
+	TEXT("CurveIK.Trace.Start"),
+	TEXT("Records the inputs of every CurveIK solve to a trace file. Optional argument: file name, defaults to Saved/CurveIK/<timestamp>.cikt"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const FString Filename = Args.Num() > 0
+			? Args[0]
+			: FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("CurveIK"), FDateTime::Now().ToString() + TEXT(".cikt"));
+
+		if (FCurveIKTraceWriter::Get().Start(Filename))
+		{
+			UE_LOG(LogCurveIKTrace, Display, TEXT("Recording CurveIK trace to %s"), *Filename);
+		}
+		else
+		{
+			UE_LOG(LogCurveIKTrace, Error, TEXT("Failed to open %s for the CurveIK trace"), *Filename);
+		}
+	}));
+
+static FAutoConsoleCommand CurveIKTraceStopCommand(
+	TEXT("CurveIK.Trace.Stop"),
+	TEXT("Ends the CurveIK trace started with CurveIK.Trace.Start"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FCurveIKTraceWriter::Get().Stop();
+	}));
+
+FCurveIKTraceWriter& FCurveIKTraceWriter::Get()
+{
+	static FCurveIKTraceWriter Instance;
+	return Instance;
+}
+
+/** A stream's buffer is appended to the file once it holds this many bytes */
+static const int32 StreamFlushBytes = 64 * 1024;
+
+bool FCurveIKTraceWriter::Start(const FString& Filename)
+{
+	FRWScopeLock WriteLock(Lock, SLT_Write);
+	StopLocked();
+
+	File.Reset(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!File)
+	{
+		return false;
+	}
+
+	uint32 Magic = CurveIKTrace::Magic;
+	uint32 Version = CurveIKTrace::Version;
+	*File << Magic << Version;
+
+	Session++;
+	Streams.Reset();
+	bRecording = true;
+	return true;
+}
+
+void FCurveIKTraceWriter::Stop()
+{
+	FRWScopeLock WriteLock(Lock, SLT_Write);
+	StopLocked();
+}
+
+void FCurveIKTraceWriter::StopLocked()
+{
+	if (File)
+	{
+		for (const TUniquePtr<FStreamState>& Stream : Streams)
+		{
+			FScopeLock StreamLock(&Stream->Lock);
+			FlushStream(*Stream);
+		}
+
+		UE_LOG(LogCurveIKTrace, Display, TEXT("Ended CurveIK trace with %d streams, %lld bytes"), Streams.Num(), File->Tell());
+		File->Close();
+		File.Reset();
+	}
+	bRecording = false;
+}
+
+void FCurveIKTraceWriter::FlushStream(FStreamState& Stream)
+{
+	if (Stream.Buffer.Num() > 0)
+	{
+		FScopeLock FileScopeLock(&FileLock);
+		File->Serialize(Stream.Buffer.GetData(), Stream.Buffer.Num());
+		Stream.Buffer.Reset();
+	}
+}
+
+int32 FCurveIKTraceWriter::AcquireStream(FCurveIKTraceStream& InOutStream)
+{
+	if (!bRecording)
+	{
+		return INDEX_NONE;
+	}
+
+	{
+		FRWScopeLock ReadLock(Lock, SLT_ReadOnly);
+		if (!bRecording)
+		{
+			return INDEX_NONE;
+		}
+		if (InOutStream.Session == Session)
+		{
+			return InOutStream.Id;
+		}
+	}
+
+	// Only a node's first solve of a trace adds its stream
+	FRWScopeLock WriteLock(Lock, SLT_Write);
+	if (!bRecording)
+	{
+		return INDEX_NONE;
+	}
+
+	if (InOutStream.Session != Session)
+	{
+		InOutStream.Session = Session;
+		InOutStream.Id = Streams.Add(MakeUnique<FStreamState>());
+	}
+	return InOutStream.Id;
+}
+
+void FCurveIKTraceWriter::RecordSolve(int32 StreamId, const FCurveIKTraceSettings& Settings, const TArray<FCurveIKChainLink>& Chain,
+                                      const FVector& Target, const FCurveIKSolveResult* Result)
+{
+	FRWScopeLock ReadLock(Lock, SLT_ReadOnly);
+	if (!File || !Streams.IsValidIndex(StreamId) || Chain.Num() == 0)
+	{
+		return;
+	}
+
+	// Only the stream's own lock is taken per solve; a node records its solves from one thread at a time
+	FStreamState& Stream = *Streams[StreamId];
+	FScopeLock StreamLock(&Stream.Lock);
+	FMemoryWriter Ar(Stream.Buffer, false, true);
+
+	if (!Stream.bHasSettings || !(Stream.Settings == Settings))
+	{
+		Stream.bHasSettings = true;
+		Stream.Settings = Settings;
+
+		uint8 Type = static_cast<uint8>(CurveIKTrace::ERecordType::Settings);
+		FCurveIKTraceSettings& S = Stream.Settings;
+		Ar << Type << StreamId;
+		Ar << S.ControlPointWeight << S.MaxIterations << S.CurveFitTolerance << S.NumPointsOnCurve << S.Stretch
+		   << S.HandleAngle << S.MaxCurveError << S.CurveType << S.bUseSharedCurveCache;
+	}
+
+	Stream.LengthsScratch.Reset(Chain.Num());
+	for (const FCurveIKChainLink& Link : Chain)
+	{
+		Stream.LengthsScratch.Add(Link.Length);
+	}
+	if (Stream.LengthsScratch != Stream.Lengths)
+	{
+		Stream.Lengths = Stream.LengthsScratch;
+
+		uint8 Type = static_cast<uint8>(CurveIKTrace::ERecordType::Chain);
+		int32 NumLinks = Stream.Lengths.Num();
+		Ar << Type << StreamId << NumLinks;
+		Ar.Serialize(Stream.Lengths.GetData(), NumLinks * sizeof(float));
+	}
+
+	uint8 Type = static_cast<uint8>(CurveIKTrace::ERecordType::Solve);
+	FVector Root = Chain[0].Position;
+	FVector TargetCopy = Target;
+	int32 Iterations = Result ? Result->Iterations : INDEX_NONE;
+	float TipError = Result ? Result->TipError : 0.f;
+	Ar << Type << StreamId << Root << TargetCopy << Iterations << TipError;
+
+	if (Stream.Buffer.Num() >= StreamFlushBytes)
+	{
+		FlushStream(Stream);
+	}
+}
+
+namespace CurveIKTrace
+{
+	/** Reads values out of the trace, failing once it runs out */
+	struct FReader
+	{
+		const uint8* Data;
+		int64 Size;
+		int64 Offset;
+
+		template <typename T>
+		bool Read(T& Out)
+		{
+			if (Offset + int64(sizeof(T)) > Size)
+			{
+				return false;
+			}
+			FMemory::Memcpy(&Out, Data + Offset, sizeof(T));
+			Offset += sizeof(T);
+			return true;
+		}
+	};
+
+	struct FDecodedSolve
+	{
+		int32 SettingsIndex;
+		int32 ChainIndex;
+		FVector Root;
+		FVector Target;
+		int32 Iterations;
+		float TipError;
+	};
+
+	struct FDecodedChain
+	{
+		int32 FirstLength;
+		int32 NumLinks;
+		float MaximumReach;
+	};
+
+	FCurveIKTraceReplayStats Replay(const uint8* Data, int64 Size, int32 NumRepeats)
+	{
+		FCurveIKTraceReplayStats Stats;
+		FReader Reader = { Data, Size, 0 };
+
+		uint32 TraceMagic = 0;
+		uint32 TraceVersion = 0;
+		if (!Reader.Read(TraceMagic) || !Reader.Read(TraceVersion) || TraceMagic != Magic || TraceVersion != Version)
+		{
+			return Stats;
+		}
+
+		// Decode everything up front, so the timed loop only solves
+		TArray<FCurveIKTraceSettings> Settings;
+		TArray<FDecodedChain> Chains;
+		TArray<float> Lengths;
+		TArray<FDecodedSolve> Solves;
+
+		// Settings and chain indices of each stream. Keyed by id rather than indexed by it, so a corrupt id
+		// cannot make the replay allocate for every id below it.
+		TMap<int32, TPair<int32, int32>> Streams;
+
+		Stats.bValid = true;
+		while (Reader.Offset < Reader.Size)
+		{
+			uint8 Type = 0;
+			int32 StreamId = INDEX_NONE;
+			if (!Reader.Read(Type) || !Reader.Read(StreamId) || StreamId < 0)
+			{
+				Stats.bValid = false;
+				break;
+			}
+
+			// The writer opens every stream with its settings, so any other record of an unknown stream is corrupt
+			TPair<int32, int32>* Stream = Streams.Find(StreamId);
+			if (!Stream && static_cast<ERecordType>(Type) == ERecordType::Settings)
+			{
+				Stream = &Streams.Add(StreamId, TPair<int32, int32>(INDEX_NONE, INDEX_NONE));
+			}
+			if (!Stream)
+			{
+				Stats.bValid = false;
+				break;
+			}
+			int32& StreamSettings = Stream->Key;
+			int32& StreamChain = Stream->Value;
+
+			bool bRead = false;
+			switch (static_cast<ERecordType>(Type))
+			{
+			case ERecordType::Settings:
+			{
+				FCurveIKTraceSettings S;
+				bRead = Reader.Read(S.ControlPointWeight) && Reader.Read(S.MaxIterations) && Reader.Read(S.CurveFitTolerance)
+					&& Reader.Read(S.NumPointsOnCurve) && Reader.Read(S.Stretch) && Reader.Read(S.HandleAngle)
+					&& Reader.Read(S.MaxCurveError) && Reader.Read(S.CurveType) && Reader.Read(S.bUseSharedCurveCache);
+				StreamSettings = Settings.Add(S);
+				break;
+			}
+			case ERecordType::Chain:
+			{
+				FDecodedChain Chain = { Lengths.Num(), 0, 0.f };
+				bRead = Reader.Read(Chain.NumLinks) && Chain.NumLinks > 0 && Reader.Offset + Chain.NumLinks * int64(sizeof(float)) <= Reader.Size;
+				if (bRead)
+				{
+					Lengths.AddUninitialized(Chain.NumLinks);
+					FMemory::Memcpy(&Lengths[Chain.FirstLength], Data + Reader.Offset, Chain.NumLinks * sizeof(float));
+					Reader.Offset += Chain.NumLinks * sizeof(float);
+
+					// Summed in chain order like FAnimNode_CurveIK does, so the reach is bit-exact
+					for (int32 LinkIndex = 1; LinkIndex < Chain.NumLinks; LinkIndex++)
+					{
+						Chain.MaximumReach += Lengths[Chain.FirstLength + LinkIndex];
+					}
+					StreamChain = Chains.Add(Chain);
+				}
+				break;
+			}
+			case ERecordType::Solve:
+			{
+				FDecodedSolve Solve = { StreamSettings, StreamChain };
+				bRead = Reader.Read(Solve.Root) && Reader.Read(Solve.Target) && Reader.Read(Solve.Iterations) && Reader.Read(Solve.TipError)
+					&& Solve.SettingsIndex != INDEX_NONE && Solve.ChainIndex != INDEX_NONE;
+				if (bRead)
+				{
+					Solves.Add(Solve);
+				}
+				break;
+			}
+			}
+
+			if (!bRead)
+			{
+				Stats.bValid = false;
+				break;
+			}
+		}
+
+		Stats.NumStreams = Streams.Num();
+		Stats.NumSolves = Solves.Num();
+
+		// Replays start cold, like a fresh process
+		FCurveIKSharedCurveCache::Get().Empty();
+
+		TArray<FCurveIKChainLink> Chain;
+		int32 CurrentChainIndex = INDEX_NONE;
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		for (int32 Repeat = 0; Repeat < FMath::Max(NumRepeats, 1); Repeat++)
+		{
+			for (int32 SolveIndex = 0; SolveIndex < Solves.Num(); SolveIndex++)
+			{
+				const FDecodedSolve& Solve = Solves[SolveIndex];
+				const FDecodedChain& DecodedChain = Chains[Solve.ChainIndex];
+				if (Solve.ChainIndex != CurrentChainIndex)
+				{
+					CurrentChainIndex = Solve.ChainIndex;
+					Chain.Reset(DecodedChain.NumLinks);
+					for (int32 LinkIndex = 0; LinkIndex < DecodedChain.NumLinks; LinkIndex++)
+					{
+						Chain.Add(FCurveIKChainLink(FVector::ZeroVector, Lengths[DecodedChain.FirstLength + LinkIndex], LinkIndex, LinkIndex));
+					}
+				}
+				Chain[0].Position = Solve.Root;
+
+				const FCurveIKTraceSettings& S = Settings[Solve.SettingsIndex];
+				const FCurveIKSolveResult Result = CurveIK_AnimationCore::SolveCurveIK(
+					Chain, Solve.Target, S.ControlPointWeight, DecodedChain.MaximumReach, S.MaxIterations, S.CurveFitTolerance,
+					S.NumPointsOnCurve, S.Stretch, nullptr, S.HandleAngle, static_cast<ECurveIKCurveType>(S.CurveType),
+					S.MaxCurveError, S.bUseSharedCurveCache != 0);
+
+				if (Repeat == 0 && Solve.Iterations != INDEX_NONE)
+				{
+					Stats.NumVerified++;
+					if (Result.Iterations != Solve.Iterations || Result.TipError != Solve.TipError)
+					{
+						Stats.NumMismatched++;
+						if (Stats.FirstMismatch == INDEX_NONE)
+						{
+							Stats.FirstMismatch = SolveIndex;
+						}
+					}
+				}
+			}
+		}
+
+		Stats.SolveSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+		return Stats;
+	}
+}
@@ -144,12 +144,12 @@ void IKCurveBezier::EvaluateMany(int32 const NumPoints)
 	}
 }
 
-FCurvePoint IKCurveBezier::Approximate(float const TargetArcLength)
+FCurvePoint IKCurveBezier::Approximate(float const TargetArcLength) const
 {
 	FCurvePoint NearestCurvePoint = FCurvePoint();
 	bool FoundMatch = false;
 	int SearchAreaStart = 0;
-	int SearchAreaEnd = CurveCache.GetPoints().Num() - 1;
+	int SearchAreaEnd = CurveCache.Num() - 1;
 	// The cache is not big enough to search
 	if (SearchAreaEnd < 0) { FoundMatch = true; }
 	if (SearchAreaStart == SearchAreaEnd)
@@ -1,4 +1,5 @@
 #include "IKCurves/IKCurveCubicBezier.h"
+#include "CurveIKStats.h"
 
 
 FVector IKCurveCubicBezier::GetHandleLocation(const FVector HandleStart, const FVector HandleDir, const float HandleHeight)
@@ -25,14 +26,16 @@ float IKCurveCubicBezier::GetHandleHeight(const FVector P1, const FVector P2, co
 
 IKCurveCubicBezier* IKCurveCubicBezier::FindCurve(FVector P1, FVector P2, FVector HandleDir, float HandleWeight,
                                                   float TargetArcLength, int MaxIterations, float CurveFitTolerance,
-                                                  int NumPoints, TArray<FVector>& ControlPoints, float HandleAngle,
-												  EIKCurveTypes CurveType)
+                                                  int NumPoints, TArray<FVector, TInlineAllocator<4>>& ControlPoints, float HandleAngle,
+												  ECurveIKCurveType CurveType, float MaxCurveError,
+												  int& OutIterations, int& OutNumSamples, float* OutHandleHeight)
 {
 	const FVector P = (P2 - P1);
 	const FVector QuadHandleStart = P1 + (P * HandleWeight);
 	float HandleHeight = GetHandleHeight(P1, P2, HandleWeight, TargetArcLength);
 	float MinHandleHeight = 0;
-	float MaxHandleHeight = P.SizeSquared();
+	// A handle this high already makes the curve at least TargetArcLength long, so the search stays below it at any scale
+	float MaxHandleHeight = TargetArcLength;
 	FVector Handle1;
 	FVector Handle2;
 
@@ -41,10 +44,15 @@ IKCurveCubicBezier* IKCurveCubicBezier::FindCurve(FVector P1, FVector P2, FVecto
 	FVector const RotatedHandleDir2 = HandleDir.RotateAngleAxis(-HandleAngle, RotationAxis);
 
 	IKCurveCubicBezier* Bezier = nullptr;
+	float BezierHandleHeight = HandleHeight;
+	int Iterations = 0;
+	int NumSamples = 0;
 	for (int i = 0; i < MaxIterations; i++)
 	{
+		Iterations++;
+		delete Bezier;
 
-		if (CurveType == IK_QuadraticBezier)
+		if (CurveType == ECurveIKCurveType::QuadraticBezier)
 		{
 			Handle1 = GetHandleLocation(QuadHandleStart, HandleDir, HandleHeight);
 			Bezier = new IKCurveCubicBezier(P1, Handle1, P2);
@@ -56,7 +64,8 @@ IKCurveCubicBezier* IKCurveCubicBezier::FindCurve(FVector P1, FVector P2, FVecto
 			Bezier = new IKCurveCubicBezier(P1, Handle1, Handle2, P2);
 		}
 
-		Bezier->EvaluateMany(NumPoints);
+		BezierHandleHeight = HandleHeight;
+		NumSamples += Bezier->EvaluateForFit(NumPoints, MaxCurveError);
 		float const Delta = Bezier->ArcLength - TargetArcLength;
 
 		if (FMath::Abs(Delta) < CurveFitTolerance) { break; }
@@ -77,20 +86,95 @@ IKCurveCubicBezier* IKCurveCubicBezier::FindCurve(FVector P1, FVector P2, FVecto
 		}
 	}
 
+	OutIterations = Iterations;
+	OutNumSamples = NumSamples;
+	if (OutHandleHeight)
+	{
+		*OutHandleHeight = BezierHandleHeight;
+	}
+
 	ControlPoints[0] = P1;
 	ControlPoints[1] = Handle1;
-	if(CurveType == IK_CubicBezier) { ControlPoints[2] = Handle2; }
+	if(CurveType == ECurveIKCurveType::CubicBezier) { ControlPoints[2] = Handle2; }
 	ControlPoints[ControlPoints.Num() - 1] = P2;
 
 	return Bezier;
 }
 
+IKCurveCubicBezier* IKCurveCubicBezier::RefineCurve(FVector P1, FVector P2, FVector HandleDir, float HandleWeight,
+                                                    float TargetArcLength, float HandleHeight, float ArcLengthSlope,
+                                                    int MaxIterations, float CurveFitTolerance, int NumPoints,
+                                                    TArray<FVector, TInlineAllocator<4>>& ControlPoints, float HandleAngle,
+                                                    ECurveIKCurveType CurveType, float MaxCurveError,
+                                                    int& OutIterations, int& OutNumSamples)
+{
+	TUniquePtr<IKCurveCubicBezier> Bezier(MakeCurve(P1, P2, HandleDir, HandleWeight, HandleHeight, HandleAngle, CurveType));
+	OutNumSamples = Bezier->EvaluateForFit(NumPoints, MaxCurveError);
+	OutIterations = 1;
+
+	const float Delta = Bezier->ArcLength - TargetArcLength;
+	if (FMath::Abs(Delta) >= CurveFitTolerance && FMath::Abs(ArcLengthSlope) > KINDA_SMALL_NUMBER)
+	{
+		const float RefinedHandleHeight = FMath::Max(HandleHeight - Delta / ArcLengthSlope, 0.f);
+		TUniquePtr<IKCurveCubicBezier> Refined(MakeCurve(P1, P2, HandleDir, HandleWeight, RefinedHandleHeight, HandleAngle, CurveType));
+		OutNumSamples += Refined->EvaluateForFit(NumPoints, MaxCurveError);
+		OutIterations++;
+
+		if (FMath::Abs(Refined->ArcLength - TargetArcLength) < FMath::Abs(Delta))
+		{
+			Bezier = MoveTemp(Refined);
+		}
+	}
+
+	// Far from the fitted distances, or where the height is not smooth, the prediction can miss. Search as FindCurve would.
+	if (FMath::Abs(Bezier->ArcLength - TargetArcLength) >= CurveFitTolerance)
+	{
+		int SearchIterations = 0;
+		int SearchNumSamples = 0;
+		TUniquePtr<IKCurveCubicBezier> Searched(FindCurve(P1, P2, HandleDir, HandleWeight, TargetArcLength, MaxIterations,
+		                                                  CurveFitTolerance, NumPoints, ControlPoints, HandleAngle, CurveType,
+		                                                  MaxCurveError, SearchIterations, SearchNumSamples));
+		OutIterations += SearchIterations;
+		OutNumSamples += SearchNumSamples;
+
+		if (Searched && FMath::Abs(Searched->ArcLength - TargetArcLength) < FMath::Abs(Bezier->ArcLength - TargetArcLength))
+		{
+			Bezier = MoveTemp(Searched);
+		}
+	}
+
+	Bezier->GetControlPoints(ControlPoints);
+	return Bezier.Release();
+}
+
+IKCurveCubicBezier* IKCurveCubicBezier::MakeCurve(FVector P1, FVector P2, FVector HandleDir, float HandleWeight, float HandleHeight,
+                                                  float HandleAngle, ECurveIKCurveType CurveType)
+{
+	const FVector P = (P2 - P1);
+	if (CurveType == ECurveIKCurveType::QuadraticBezier)
+	{
+		return new IKCurveCubicBezier(P1, GetHandleLocation(P1 + (P * HandleWeight), HandleDir, HandleHeight), P2);
+	}
+
+	FVector const RotationAxis = FVector::CrossProduct(P, HandleDir).GetSafeNormal();
+	const FVector Handle1 = GetHandleLocation(P1, HandleDir.RotateAngleAxis(HandleAngle, RotationAxis), HandleHeight);
+	const FVector Handle2 = GetHandleLocation(P2, HandleDir.RotateAngleAxis(-HandleAngle, RotationAxis), HandleHeight);
+	return new IKCurveCubicBezier(P1, Handle1, Handle2, P2);
+}
+
+int32 IKCurveCubicBezier::EvaluateForFit(int32 const NumPoints, float const MaxCurveError)
+{
+	const int32 CurveNumPoints = MaxCurveError > 0 ? GetNumPointsForError(MaxCurveError) : NumPoints;
+	EvaluateMany(CurveNumPoints);
+	return CurveNumPoints;
+}
+
 FVector IKCurveCubicBezier::Evaluate(const float T) const
 {
 	const auto Pow = FGenericPlatformMath::Pow;
 
 	// Quadratic:
-	if (CurveType == IK_QuadraticBezier)
+	if (CurveType == ECurveIKCurveType::QuadraticBezier)
 	{
 		return Pow(1 - T, 2) * A + (1 - T) * 2 * T * B + (T * T) * C;
 	}
@@ -106,7 +190,7 @@ FVector IKCurveCubicBezier::EvaluateDerivative(float T) const
 {
 	const auto Pow = FGenericPlatformMath::Pow;
 	// Quadratic:
-	if (CurveType == IK_QuadraticBezier)
+	if (CurveType == ECurveIKCurveType::QuadraticBezier)
 	{
 		return A * (2 * T - 2) + (2 * C - 4 * B) * T + 2 * B;
 	}
@@ -153,8 +237,35 @@ FVector IKCurveCubicBezier::EvaluateNormal(float T) const
 	return N;
 }
 
+/** Upper limit on the sample count derived from an error bound, so tiny bounds cannot stall a solve */
+static const int32 MaxErrorBoundedPoints = 256;
+
+/*
+ * The polyline through N + 1 evenly spaced samples deviates from the curve by at most max|B''| / (8 N^2),
+ * and a degree n curve has max|B''| <= n (n - 1) times its largest control polygon second difference.
+ */
+int32 IKCurveCubicBezier::GetNumPointsForError(float const MaxError) const
+{
+	float MaxSecondDerivative;
+	if (CurveType == ECurveIKCurveType::QuadraticBezier)
+	{
+		MaxSecondDerivative = 2 * (A - 2 * B + C).Size();
+	}
+	else
+	{
+		MaxSecondDerivative = 6 * FMath::Max((A - 2 * B + C).Size(), (B - 2 * C + D).Size());
+	}
+
+	const float NumSegments = FMath::Sqrt(MaxSecondDerivative / (8 * MaxError));
+	return FMath::Clamp(FMath::CeilToInt(NumSegments) + 1, 2, MaxErrorBoundedPoints);
+}
+
 void IKCurveCubicBezier::EvaluateMany(int32 const NumPoints)
 {
+	SCOPE_CYCLE_COUNTER(STAT_CurveIK_Sampling);
+	INC_DWORD_STAT_BY(STAT_CurveIK_CacheSamples, NumPoints);
+	CSV_CUSTOM_STAT(CurveIK, CacheSamples, NumPoints, ECsvCustomStatOp::Accumulate);
+
 	const float MinT = 0;
 	const float MaxT = 1;
 	const float StepSize = MaxT / (NumPoints - 1);
@@ -177,12 +288,12 @@ void IKCurveCubicBezier::EvaluateMany(int32 const NumPoints)
 	}
 }
 
-FCurvePoint IKCurveCubicBezier::Approximate(float const TargetArcLength)
+FCurvePoint IKCurveCubicBezier::Approximate(float const TargetArcLength) const
 {
 	FCurvePoint NearestCurvePoint = FCurvePoint();
 	bool FoundMatch = false;
 	int SearchAreaStart = 0;
-	int SearchAreaEnd = CurveCache.GetPoints().Num() - 1;
+	int SearchAreaEnd = CurveCache.Num() - 1;
 	// The cache is not big enough to search
 	if (SearchAreaEnd < 0) { FoundMatch = true; }
 	if (SearchAreaStart == SearchAreaEnd)
@@ -238,3 +349,21 @@ FCurvePoint IKCurveCubicBezier::Approximate(float const TargetArcLength)
 
 	return NearestCurvePoint;
 }
+
+void IKCurveCubicBezier::Transform(const FTransform& Transform)
+{
+	A = Transform.TransformPosition(A);
+	B = Transform.TransformPosition(B);
+	C = Transform.TransformPosition(C);
+	D = Transform.TransformPosition(D);
+	ArcLength *= Transform.GetMaximumAxisScale();
+	CurveCache.Transform(Transform);
+}
+
+void IKCurveCubicBezier::GetControlPoints(TArray<FVector, TInlineAllocator<4>>& OutControlPoints) const
+{
+	OutControlPoints[0] = A;
+	OutControlPoints[1] = B;
+	OutControlPoints[2] = C;
+	if (CurveType == ECurveIKCurveType::CubicBezier) { OutControlPoints[3] = D; }
+}
@@ -10,7 +10,7 @@ IKCurveLine* IKCurveLine::FindCurve(FVector P1, FVector P2, FVector HandleDir, f
 
 FVector IKCurveLine::Evaluate(float T) const
 {
-	return Direction * Length * T;
+	return StartPoint + Direction * Length * T;
 }
 
 FVector IKCurveLine::EvaluateDerivative(float T) const
@@ -23,7 +23,7 @@ FVector IKCurveLine::EvaluateNormal(float T) const
 	return DefaultNormalDir;
 }
 
-FCurvePoint IKCurveLine::Approximate(float TargetArcLength)
+FCurvePoint IKCurveLine::Approximate(float TargetArcLength) const
 {
 	FCurvePoint CurvePoint;
 	float const T = TargetArcLength / Length;
@@ -0,0 +1,43 @@
+#include "IKCurves/IKCurveSharedBezier.h"
+
+IKCurveSharedBezier::IKCurveSharedBezier(const TSharedRef<const IKCurveCubicBezier, ESPMode::ThreadSafe>& Curve, const FTransform& Transform)
+	: Curve(Curve)
+	, Transform(Transform)
+	, Scale(Transform.GetMaximumAxisScale())
+{
+	ArcLength = Curve->ArcLength * Scale;
+}
+
+FVector IKCurveSharedBezier::Evaluate(float T) const
+{
+	return Transform.TransformPosition(Curve->Evaluate(T));
+}
+
+FVector IKCurveSharedBezier::EvaluateDerivative(float T) const
+{
+	return Transform.TransformVector(Curve->EvaluateDerivative(T));
+}
+
+FVector IKCurveSharedBezier::EvaluateNormal(float T) const
+{
+	return Transform.TransformVector(Curve->EvaluateNormal(T));
+}
+
+FCurvePoint IKCurveSharedBezier::Approximate(float TargetArcLength) const
+{
+	FCurvePoint CurvePoint = Curve->Approximate(TargetArcLength / Scale);
+	CurvePoint.ArcLength *= Scale;
+	CurvePoint.Point = Transform.TransformPosition(CurvePoint.Point);
+	CurvePoint.Tangent = Transform.TransformVectorNoScale(CurvePoint.Tangent);
+	CurvePoint.Normal = Transform.TransformVectorNoScale(CurvePoint.Normal);
+	return CurvePoint;
+}
+
+void IKCurveSharedBezier::GetControlPoints(TArray<FVector, TInlineAllocator<4>>& OutControlPoints) const
+{
+	Curve->GetControlPoints(OutControlPoints);
+	for (FVector& ControlPoint : OutControlPoints)
+	{
+		ControlPoint = Transform.TransformPosition(ControlPoint);
+	}
+}
@@ -0,0 +1,191 @@
+#include "CoreMinimal.h"
+#include "CurveIKBatch.h"
+#include "CurveIKCore.h"
+#include "CurveIKTestChains.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace CurveIKSolverTest
+{
+	/** Allowed difference between a solved link's length and its bone length, as a fraction of the bone length */
+	static const float LinkLengthTolerance = 0.1f;
+
+	/** Allowed distance from the tip to a reachable target, as a fraction of the chain's reach */
+	static const float TipTolerance = 0.02f;
+
+	/**
+	 * Mean time budget per solve for the performance test, at the FAnimNode_CurveIK defaults. Deliberately loose, so
+	 * that only real regressions trip it on shared build machines.
+	 */
+	static const double SolveBudgetMicroseconds = 100.0;
+
+	/** Allowed distance between a link placed by the batched solver and by SolveCurveIK, as a fraction of the chain's reach */
+	static const float BatchPositionTolerance = 0.005f;
+
+	static const int32 NumCorrectnessSolves = 2000;
+
+	/** Not a multiple of the batch lane count, so the last group is partly empty */
+	static const int32 NumBatchChains = 1001;
+	static const int32 NumPerformanceSolves = 10000;
+
+	/** Builds a chain of 3-16 links at a random root, with a target between MinReach and MaxReach of its reach */
+	static FCurveIKTestChain MakeRandomChain(FRandomStream& Random, float MinReach, float MaxReach)
+	{
+		const FVector Root = Random.GetUnitVector() * Random.FRandRange(0.f, 500.f);
+		FCurveIKTestChain Chain = CurveIK_AnimationCore::MakeRandomChain(Random, Root, 3, 16, 5.f, 20.f);
+		Chain.Target = CurveIK_AnimationCore::GetRandomTarget(Random, Chain, MinReach, MaxReach);
+		return Chain;
+	}
+
+	static FCurveIKSolveResult Solve(FCurveIKTestChain& Chain, ECurveIKCurveType CurveType)
+	{
+		return CurveIK_AnimationCore::SolveCurveIK(Chain.Links, Chain.Target, 0.5f, Chain.MaximumReach, 100, 0.01f, 20, 0.f,
+		                                           nullptr, 0.f, CurveType);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCurveIKSolverCorrectnessTest, "CurveIK.Solver.Correctness",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCurveIKSolverCorrectnessTest::RunTest(const FString& Parameters)
+{
+	using namespace CurveIKSolverTest;
+
+	FRandomStream Random(0);
+	for (const ECurveIKCurveType CurveType : { ECurveIKCurveType::QuadraticBezier, ECurveIKCurveType::CubicBezier })
+	{
+		int32 NumLengthErrors = 0;
+		int32 NumTipErrors = 0;
+
+		for (int32 SolveIndex = 0; SolveIndex < NumCorrectnessSolves; SolveIndex++)
+		{
+			// Half the targets are in reach and half are beyond it, where the chain is laid straight
+			const bool bReachable = SolveIndex % 2 == 0;
+			FCurveIKTestChain Chain = bReachable ? MakeRandomChain(Random, 0.3f, 0.95f) : MakeRandomChain(Random, 1.05f, 1.5f);
+			const FVector Root = Chain.Links[0].Position;
+			const FCurveIKSolveResult Result = Solve(Chain, CurveType);
+
+			for (int32 LinkIndex = 1; LinkIndex < Chain.Links.Num(); LinkIndex++)
+			{
+				const FCurveIKChainLink& Link = Chain.Links[LinkIndex];
+				const float SolvedLength = FVector::Dist(Link.Position, Chain.Links[LinkIndex - 1].Position);
+				if (FMath::Abs(SolvedLength - Link.Length) > LinkLengthTolerance * Link.Length && NumLengthErrors++ == 0)
+				{
+					AddError(FString::Printf(TEXT("%s solve %d: link %d is %f long instead of %f"),
+					                         LexToString(CurveType), SolveIndex, LinkIndex, SolvedLength, Link.Length));
+				}
+			}
+
+			if (!Chain.Links[0].Position.Equals(Root, 0.01f))
+			{
+				AddError(FString::Printf(TEXT("%s solve %d: the root moved"), LexToString(CurveType), SolveIndex));
+			}
+
+			if (bReachable && Result.TipError > TipTolerance * Chain.MaximumReach && NumTipErrors++ == 0)
+			{
+				AddError(FString::Printf(TEXT("%s solve %d: the tip is %f from a reachable target, with a reach of %f"),
+				                         LexToString(CurveType), SolveIndex, Result.TipError, Chain.MaximumReach));
+			}
+		}
+
+		TestEqual(FString::Printf(TEXT("%s solves with a link length error"), LexToString(CurveType)), NumLengthErrors, 0);
+		TestEqual(FString::Printf(TEXT("%s solves missing a reachable target"), LexToString(CurveType)), NumTipErrors, 0);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCurveIKSolverBatchTest, "CurveIK.Solver.Batch",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCurveIKSolverBatchTest::RunTest(const FString& Parameters)
+{
+	using namespace CurveIKSolverTest;
+
+	FRandomStream Random(0);
+	for (const ECurveIKCurveType CurveType : { ECurveIKCurveType::QuadraticBezier, ECurveIKCurveType::CubicBezier })
+	{
+		FCurveIKBatchSettings Settings;
+		Settings.CurveType = CurveType;
+
+		// Each chain is solved by both paths from the same copy, with targets in and out of reach
+		TArray<FCurveIKTestChain> Chains;
+		for (int32 ChainIndex = 0; ChainIndex < NumBatchChains; ChainIndex++)
+		{
+			Chains.Add(MakeRandomChain(Random, 0.1f, 1.3f));
+		}
+
+		TArray<FCurveIKTestChain> BatchChains = Chains;
+		TArray<FCurveIKBatchChain> Batch;
+		for (FCurveIKTestChain& Chain : BatchChains)
+		{
+			FCurveIKBatchChain& BatchChain = Batch.AddDefaulted_GetRef();
+			BatchChain.Chain = &Chain.Links;
+			BatchChain.TargetLocation = Chain.Target;
+			BatchChain.MaximumReach = Chain.MaximumReach;
+		}
+
+		TArray<FCurveIKSolveResult> BatchResults;
+		BatchResults.SetNum(Batch.Num());
+		CurveIK_AnimationCore::SolveCurveIKBatch(Batch, Settings, BatchResults);
+
+		int32 NumMismatches = 0;
+		for (int32 ChainIndex = 0; ChainIndex < Chains.Num(); ChainIndex++)
+		{
+			FCurveIKTestChain& Chain = Chains[ChainIndex];
+			CurveIK_AnimationCore::SolveCurveIK(Chain.Links, Chain.Target, Settings.ControlPointWeight, Chain.MaximumReach,
+			                                    Settings.MaxIterations, Settings.CurveFitTolerance, Settings.NumPointsOnCurve,
+			                                    Settings.Stretch, nullptr, Settings.HandleAngle, CurveType);
+
+			for (int32 LinkIndex = 0; LinkIndex < Chain.Links.Num(); LinkIndex++)
+			{
+				const float Distance = FVector::Dist(Chain.Links[LinkIndex].Position, BatchChains[ChainIndex].Links[LinkIndex].Position);
+				if (Distance > BatchPositionTolerance * Chain.MaximumReach && NumMismatches++ == 0)
+				{
+					AddError(FString::Printf(TEXT("%s chain %d: the batched solve placed link %d %f away from SolveCurveIK, with a reach of %f"),
+					                         LexToString(CurveType), ChainIndex, LinkIndex, Distance, Chain.MaximumReach));
+				}
+			}
+		}
+
+		TestEqual(FString::Printf(TEXT("%s links placed differently by the batched solve"), LexToString(CurveType)), NumMismatches, 0);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCurveIKSolverPerformanceTest, "CurveIK.Solver.Performance",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FCurveIKSolverPerformanceTest::RunTest(const FString& Parameters)
+{
+	using namespace CurveIKSolverTest;
+
+	FRandomStream Random(0);
+	TArray<FCurveIKTestChain> Chains;
+	for (int32 ChainIndex = 0; ChainIndex < 256; ChainIndex++)
+	{
+		Chains.Add(MakeRandomChain(Random, 0.1f, 1.3f));
+	}
+
+	for (const ECurveIKCurveType CurveType : { ECurveIKCurveType::QuadraticBezier, ECurveIKCurveType::CubicBezier })
+	{
+		// Solving only reads the root position and link lengths, so chains are solved again in place
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 SolveIndex = 0; SolveIndex < NumPerformanceSolves; SolveIndex++)
+		{
+			Solve(Chains[SolveIndex % Chains.Num()], CurveType);
+		}
+		const double MeanMicroseconds = (FPlatformTime::Seconds() - StartTime) * 1000000.0 / NumPerformanceSolves;
+
+		AddInfo(FString::Printf(TEXT("%s: %.2f us per solve, budget %.2f us"), LexToString(CurveType), MeanMicroseconds, SolveBudgetMicroseconds));
+		TestTrue(FString::Printf(TEXT("%s mean solve time is within budget"), LexToString(CurveType)), MeanMicroseconds <= SolveBudgetMicroseconds);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
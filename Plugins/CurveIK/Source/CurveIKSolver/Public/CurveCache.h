@@ -0,0 +1,40 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct CURVEIKSOLVER_API FCurvePoint
+{
+public:
+	float ArcLength;
+	float T;
+	FVector Point;
+	FVector Tangent;
+	FVector Normal;
+};
+
+struct CURVEIKSOLVER_API FCurveIK_CurveCache
+{
+public:
+	void Add(float ArcLength, FVector CurvePosition, float T);
+
+	FCurvePoint Get(int Index) const;
+
+	void Empty();
+
+	FVector FindNearest(float ArcLength);
+	
+	TArray<FVector> GetPoints();
+
+	int32 Num() const { return CurveCache.Num(); }
+
+	const TArray<FCurvePoint>& GetCurvePoints() const { return CurveCache; }
+
+	SIZE_T GetAllocatedSize() const { return CurveCache.GetAllocatedSize(); }
+
+	/** Moves the cached points by a similarity transform and scales their arc-lengths to match */
+	void Transform(const FTransform& Transform);
+
+private:
+	TArray<FCurvePoint> CurveCache;
+};
+
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CurveIKCore.h"
+
+/** One chain of a batched solve */
+struct FCurveIKBatchChain
+{
+	/** Links to place. Only the root position and link lengths are read, as with SolveCurveIK. */
+	TArray<FCurveIKChainLink>* Chain = nullptr;
+
+	FVector TargetLocation = FVector::ZeroVector;
+
+	float MaximumReach = 0.f;
+};
+
+/** Solver settings shared by every chain of a batched solve. They mean the same as in SolveCurveIK. */
+struct FCurveIKBatchSettings
+{
+	float ControlPointWeight = 0.5f;
+	int32 MaxIterations = 100;
+	float CurveFitTolerance = 0.01f;
+	int32 NumPointsOnCurve = 20;
+	float Stretch = 0.f;
+	float HandleAngle = 0.f;
+	ECurveIKCurveType CurveType = ECurveIKCurveType::QuadraticBezier;
+};
+
+namespace CurveIK_AnimationCore
+{
+	/** Number of chains fitted side by side, one per lane of a VectorRegister */
+	static const int32 BatchLaneCount = 4;
+
+	/**
+	 * Solves many chains with the same settings, fitting and sampling BatchLaneCount chains at a time with one
+	 * SIMD lane per chain. Lanes whose fit converges are masked out while the rest of their group keeps iterating.
+	 *
+	 * Gives the same results as calling SolveCurveIK on each chain up to float rounding. Colliders, the shared
+	 * curve cache, MaxCurveError and debug data are not supported; chains that need them should use SolveCurveIK.
+	 *
+	 * @param OutResults Receives one result per chain, in the same order as Chains
+	 */
+	CURVEIKSOLVER_API void SolveCurveIKBatch(TArrayView<const FCurveIKBatchChain> Chains, const FCurveIKBatchSettings& Settings,
+	                                         TArrayView<FCurveIKSolveResult> OutResults);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Capsules and spheres that a fitted curve should stay out of, kept in parallel arrays of starts, ends and radii.
+ * The narrow phase tests one collider at a time. A sphere is a capsule whose ends coincide.
+ *
+ * Colliders are bounded by a simple BVH. Call Build after adding colliders and before querying them, and Refit
+ * after moving them.
+ */
+class CURVEIKSOLVER_API FCurveIKColliders
+{
+public:
+	void AddSphere(const FVector& Center, float Radius);
+	void AddCapsule(const FVector& Start, const FVector& End, float Radius);
+
+	/** Removes all colliders, keeping the allocations for the next frame */
+	void Reset();
+
+	int32 Num() const { return Radii.Num(); }
+
+	/** Heap memory used by the colliders and their BVH */
+	SIZE_T GetAllocatedSize() const;
+
+	/** Rebuilds the BVH over the current colliders */
+	void Build();
+
+	/** Moves an existing collider. Call Refit or Build before querying again. */
+	void MoveCapsule(int32 Collider, const FVector& Start, const FVector& End);
+
+	/**
+	 * Recomputes the bounds of the BVH after colliders moved, keeping its structure. Much cheaper than Build, but
+	 * the tree loosens as colliders drift away from where it was built.
+	 */
+	void Refit();
+
+	/** Gathers the colliders whose bounds overlap Sphere */
+	void Overlap(const FSphere& Sphere, TArray<int32, TInlineAllocator<16>>& OutColliders) const;
+
+	/** True if Point lies inside the given collider */
+	bool Contains(int32 Collider, const FVector& Point) const;
+
+	/**
+	 * How far Point is inside the deepest of Colliders, or zero if it is outside all of them.
+	 *
+	 * @param Inflate Added to every collider's radius, to account for the thickness of the chain
+	 */
+	float GetPenetration(const FVector& Point, const TArray<int32, TInlineAllocator<16>>& Colliders, float Inflate) const;
+
+private:
+	TArray<FVector> Starts;
+	TArray<FVector> Ends;
+	TArray<float> Radii;
+
+	struct FNode
+	{
+		FBox Bounds;
+
+		/** Index of the first child node, the second follows it. INDEX_NONE for leaves. */
+		int32 FirstChild;
+
+		/** Range of NodeColliders covered by a leaf */
+		int32 FirstCollider;
+		int32 NumColliders;
+	};
+
+	TArray<FNode> Nodes;
+
+	/** Collider indices ordered so that every leaf covers a contiguous range */
+	TArray<int32> NodeColliders;
+
+	FBox GetColliderBounds(int32 Collider) const;
+	void BuildNode(int32 NodeIndex, int32 FirstCollider, int32 NumColliders);
+};
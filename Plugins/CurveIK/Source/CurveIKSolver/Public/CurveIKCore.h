@@ -0,0 +1,189 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CurveCache.h"
+#include "IKCurves/IKCurve.h"
+
+class FCurveIKColliders;
+class FCurveIKHeightCurve;
+
+
+struct FCurveIKChainLink
+{
+public:
+	/** Position of bone in component space. */
+	FVector Position;
+
+	/** Distance to its parent link. */
+	float Length;
+
+	/* The point on the curve where the base of this link lies */
+	FCurvePoint CurvePoint;
+
+	/* The true down direction of the bone's transform after being placed and rotated by the solver */
+	FVector BoneDownVector;
+
+	/** Bone Index in SkeletalMesh */
+	int32 BoneIndex;
+
+	/** Transform Index that this control will output */
+	int32 TransformIndex;
+
+	/** Default Direction to Parent */
+	FVector DefaultDirToParent;
+
+	/** Child bones which are overlapping this bone.
+	* They have a zero length distance, so they will inherit this bone's transformation. */
+	TArray<int32> ChildZeroLengthTransformIndices;
+
+	FCurveIKChainLink()
+		: Position(FVector::ZeroVector)
+		, Length(0.f)
+		, BoneDownVector(FVector::ZeroVector)
+		, BoneIndex(INDEX_NONE)
+		, TransformIndex(INDEX_NONE)
+		, DefaultDirToParent(FVector(-1.f, 0.f, 0.f))
+	{
+	}
+
+	FCurveIKChainLink(const FVector& InPosition, const float InLength, const int32 InBoneIndex, const int32 InTransformIndex)
+		: Position(InPosition)
+		, Length(InLength)
+		, BoneDownVector(FVector::ZeroVector)
+		, BoneIndex(InBoneIndex)
+		, TransformIndex(InTransformIndex)
+		, DefaultDirToParent(FVector(-1.f, 0.f, 0.f))
+	{
+	}
+
+	FCurveIKChainLink(const FVector& InPosition, const float InLength, const int32 InBoneIndex, const int32 InTransformIndex, const FVector& InDefaultDirToParent)
+		: Position(InPosition)
+		, Length(InLength)
+		, BoneDownVector(FVector::ZeroVector)
+		, BoneIndex(InBoneIndex)
+		, TransformIndex(InTransformIndex)
+		, DefaultDirToParent(InDefaultDirToParent)
+	{
+	}
+
+	SIZE_T GetAllocatedSize() const { return ChildZeroLengthTransformIndices.GetAllocatedSize(); }
+};
+
+struct FCurveIKDebugData
+{
+public:
+	TArray<FVector> ControlPoints;
+	FVector P1;
+	FVector P2;
+	FVector RightVector;
+	FVector UpVector;
+	FVector HandleDir;
+
+	FCurveIK_CurveCache CurveCache;
+
+	SIZE_T GetAllocatedSize() const { return ControlPoints.GetAllocatedSize() + CurveCache.GetAllocatedSize(); }
+};
+
+/** The kind of curve the solver placed the chain along */
+enum class ECurveIKSolvePath : uint8
+{
+	/** The target was out of reach, so the chain was laid straight towards it */
+	Line,
+
+	/** A bezier curve was fitted to the length of the chain */
+	Bezier,
+};
+
+inline const TCHAR* LexToString(ECurveIKSolvePath Path)
+{
+	return Path == ECurveIKSolvePath::Line ? TEXT("Line") : TEXT("Bezier");
+}
+
+/** Describes how a call to CurveIK_AnimationCore::SolveCurveIK went */
+struct FCurveIKSolveResult
+{
+	/** True if the curve's arc-length was within CurveFitTolerance of the chain length. Always true for lines. */
+	bool bConverged = false;
+
+	/** Number of curves evaluated while fitting. Zero for lines. */
+	int32 Iterations = 0;
+
+	/** Number of points evaluated into curve caches across all iterations */
+	int32 NumCurveSamples = 0;
+
+	/** Arc-length of the fitted curve minus the length of the chain */
+	float ArcLengthResidual = 0.f;
+
+	/** Distance from the tip link to the target, or to the closest reachable point towards an out of reach target */
+	float TipError = 0.f;
+
+	/** True if the curve was taken from FCurveIKSharedCurveCache instead of being fitted */
+	bool bSharedCacheHit = false;
+
+	/** Number of extra fits with a rotated handle direction made to steer the curve out of colliders */
+	int32 CollisionRefits = 0;
+
+	/** How far the final curve still penetrates the colliders */
+	float CollisionPenetration = 0.f;
+
+	ECurveIKSolvePath Path = ECurveIKSolvePath::Bezier;
+};
+
+namespace CurveIK_AnimationCore
+{
+	/** Heap memory used by a chain's links */
+	inline SIZE_T GetChainAllocatedSize(const TArray<FCurveIKChainLink>& Chain)
+	{
+		SIZE_T Size = Chain.GetAllocatedSize();
+		for (const FCurveIKChainLink& Link : Chain)
+		{
+			Size += Link.GetAllocatedSize();
+		}
+		return Size;
+	}
+
+	/**
+	 * Places the links of InOutChain along a curve from the root link to TargetLocation.
+	 *
+	 * Reentrant: the solver only writes to its arguments, apart from stats and FCurveIKSharedCurveCache, which are
+	 * thread-safe. Concurrent calls, such as from parallel anim evaluation, must pass their own chain and debug data.
+	 *
+	 * @param MaxCurveError When greater than zero, the number of points sampled on each curve is derived from this
+	 *                      maximum positional error instead of NumPointsOnCurve
+	 * @param bUseSharedCurveCache Reuse curves fitted by other chains with the same settings through FCurveIKSharedCurveCache
+	 * @param Colliders When set, a fitted curve that passes through any of these is refitted with its handle direction
+	 *                  rotated about the chord. Colliders that contain the root or the target are ignored. Built by the caller.
+	 * @param CollisionRadius The thickness of the chain, added to the radius of every collider
+	 * @param HeightCurve When set, curves start from the handle height it predicts for the root to target distance and
+	 *                    are refined once, and only searched for if that misses. Must be built with the same settings
+	 *                    and MaximumReach. Takes precedence over the shared curve cache.
+	 * @param CurveIKDebugData Receives the curve and its construction vectors for debug drawing. Pass null to skip the capture.
+	 *
+	 * @return Whether the fit converged, how long it took and how close the tip got to the target
+	 */
+	CURVEIKSOLVER_API FCurveIKSolveResult SolveCurveIK(TArray<FCurveIKChainLink>& InOutChain, const FVector& TargetLocation,
+	                              float ControlPointWeight, float MaximumReach, int MaxIterations, float CurveFitTolerance,
+	                              int NumPointsOnCurve, float Stretch, FCurveIKDebugData* CurveIKDebugData, float HandleAngle, ECurveIKCurveType CurveType,
+	                              float MaxCurveError = 0.f, bool bUseSharedCurveCache = false,
+	                              const FCurveIKColliders* Colliders = nullptr, float CollisionRadius = 0.f,
+	                              const FCurveIKHeightCurve* HeightCurve = nullptr);
+
+	/**
+	 * Turns a link's bone from OldDir to NewDir, the direction to its child before and after solving, then rolls it about
+	 * NewDir until its down vector (-Z) follows the curve normal. This is how the anim node orients solved bones.
+	 *
+	 * @param OutSwing Receives the rotation from OldDir to NewDir, before the roll correction
+	 * @return The bone's new rotation, in the same space as BoneRotation and the directions
+	 */
+	CURVEIKSOLVER_API FQuat OrientLinkBone(const FQuat& BoneRotation, const FVector& OldDir, const FVector& NewDir,
+	                                       const FVector& CurveNormal, FQuat& OutSwing);
+
+	/** Angle in degrees, in [-180, 180], that a bone rolls about its local BoneAxis between rotations From and To */
+	CURVEIKSOLVER_API float GetBoneRoll(const FQuat& From, const FQuat& To, const FVector& BoneAxis = FVector::ForwardVector);
+
+	/**
+	 * Orients the bones of a solved chain the way the anim node does, for a chain laid out along X with identity bone
+	 * rotations before solving. Writes one rotation per link except the tip, whose bone the node does not turn.
+	 */
+	CURVEIKSOLVER_API void GetSolvedBoneRotations(const TArray<FCurveIKChainLink>& Links, TArray<FQuat>& OutRotations);
+};
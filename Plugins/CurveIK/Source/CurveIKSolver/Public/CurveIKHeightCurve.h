@@ -0,0 +1,54 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IKCurves/IKCurve.h"
+
+/**
+ * The handle height the solver fits for one chain, as a function of the distance from its root to the target.
+ *
+ * For fixed link lengths and solver settings, the fitted height only depends on that distance, and it varies
+ * smoothly with it. Fitting it once at a handful of distances across [0, MaximumReach] lets later solves start from
+ * an interpolated height and refine it at most once, instead of bisecting for every solve. Immutable once built,
+ * so it can be shared with solves on other threads.
+ */
+class CURVEIKSOLVER_API FCurveIKHeightCurve
+{
+public:
+	/** The solver settings a curve is fitted with. A curve only applies to solves with the same settings. */
+	struct FSettings
+	{
+		float MaximumReach = 0.f;
+		float ControlPointWeight = 0.f;
+		int32 MaxIterations = 0;
+		float CurveFitTolerance = 0.f;
+		int32 NumPointsOnCurve = 0;
+		float HandleAngle = 0.f;
+		float MaxCurveError = 0.f;
+		ECurveIKCurveType CurveType = ECurveIKCurveType::QuadraticBezier;
+
+		bool operator==(const FSettings& Other) const;
+		bool operator!=(const FSettings& Other) const { return !(*this == Other); }
+	};
+
+	/** Fits the full solver at NumKeys evenly spaced distances */
+	explicit FCurveIKHeightCurve(const FSettings& InSettings);
+
+	const FSettings& GetSettings() const { return Settings; }
+
+	/**
+	 * Interpolates the curve at Distance, clamped to [0, MaximumReach].
+	 *
+	 * @param OutHandleHeight Receives the predicted handle height
+	 * @param OutArcLengthSlope Receives the rate of change of arc-length with handle height, for refining the prediction
+	 */
+	void Evaluate(float Distance, float& OutHandleHeight, float& OutArcLengthSlope) const;
+
+	/** Number of distances the solver is fitted at */
+	static const int32 NumKeys = 17;
+
+private:
+	FSettings Settings;
+	float KeySpacing = 0.f;
+	TArray<float, TFixedAllocator<NumKeys>> HandleHeights;
+	TArray<float, TFixedAllocator<NumKeys>> ArcLengthSlopes;
+};
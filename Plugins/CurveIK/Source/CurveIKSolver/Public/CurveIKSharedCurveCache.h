@@ -0,0 +1,87 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "IKCurves/IKCurveSharedBezier.h"
+
+/**
+ * Process-wide cache of fitted bezier curves, shared by every chain that solves with the same settings.
+ *
+ * A fitted curve only depends on the chord length relative to the chain's reach, so curves are fitted once
+ * in a canonical space (root at the origin, chord along X, handle direction along Z, fixed reach) and moved
+ * into place with a similarity transform. The chord ratio is quantized finely enough that the transformed
+ * curve still meets the caller's CurveFitTolerance. Safe to use from any thread.
+ *
+ * Holds up to CurveIK.SharedCurveCache.MaxCurves curves. When it is full, the least recently used curves are evicted.
+ */
+class CURVEIKSOLVER_API FCurveIKSharedCurveCache
+{
+public:
+	static FCurveIKSharedCurveCache& Get();
+
+	/**
+	 * Drop-in replacement for IKCurveCubicBezier::FindCurve that reuses a cached canonical curve when one exists.
+	 *
+	 * @param OutIterations Receives the number of curves evaluated, which is zero on a cache hit
+	 * @param OutNumSamples Receives the number of points evaluated, which is zero on a cache hit
+	 * @param bOutCacheHit Receives whether the curve came from the cache
+	 *
+	 * @return The fitted curve in place, or null if MaxIterations is less than one. It refers to the cached curve instead of
+	 *         copying it. The caller takes ownership of the returned curve.
+	 */
+	IKCurveSharedBezier* FindCurve(FVector P1, FVector P2, FVector HandleDir, float HandleWeight, float TargetArcLength,
+	                              int MaxIterations, float CurveFitTolerance, int NumPoints,
+	                              TArray<FVector, TInlineAllocator<4>>& ControlPoints, float HandleAngle,
+	                              ECurveIKCurveType CurveType, float MaxCurveError,
+	                              int& OutIterations, int& OutNumSamples, bool& bOutCacheHit);
+
+	/** Removes all cached curves */
+	void Empty();
+
+	/** Number of cached curves */
+	int32 Num() const;
+
+	/** Heap memory used by the cached curves. Evicted curves are freed once no solve is using them. */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	struct FKey
+	{
+		int32 ChordRatioIndex;
+		float HandleWeight;
+		float HandleAngle;
+		float CurveFitTolerance;
+		float MaxCurveError;
+		int32 MaxIterations;
+		int32 NumPoints;
+		ECurveIKCurveType CurveType;
+
+		bool operator==(const FKey& Other) const;
+		friend uint32 GetTypeHash(const FKey& Key)
+		{
+			uint32 Hash = GetTypeHash(Key.ChordRatioIndex);
+			Hash = HashCombine(Hash, GetTypeHash(Key.HandleWeight));
+			Hash = HashCombine(Hash, GetTypeHash(Key.HandleAngle));
+			Hash = HashCombine(Hash, GetTypeHash(Key.CurveFitTolerance));
+			Hash = HashCombine(Hash, GetTypeHash(Key.MaxCurveError));
+			Hash = HashCombine(Hash, GetTypeHash(Key.MaxIterations));
+			Hash = HashCombine(Hash, GetTypeHash(Key.NumPoints));
+			return HashCombine(Hash, GetTypeHash(static_cast<uint8>(Key.CurveType)));
+		}
+	};
+
+	struct FEntry
+	{
+		TSharedRef<const IKCurveCubicBezier, ESPMode::ThreadSafe> Curve;
+
+		/** UseClock when the curve was last found or added. Written under the read lock, so it is set atomically. */
+		int64 LastUsed;
+	};
+
+	/** Evicts the least recently used curves until there is room for one more. Requires the write lock. */
+	void EvictLeastRecentlyUsed(int32 MaxCurves);
+
+	mutable FRWLock Lock;
+	TMap<FKey, FEntry> Curves;
+	TAtomic<int64> UseClock { 0 };
+};
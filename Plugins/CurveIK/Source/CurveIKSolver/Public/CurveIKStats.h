@@ -0,0 +1,35 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+/*
+ * Stats for the CurveIK solver. View them in game with "stat CurveIK", or capture the
+ * CSV counterparts with -csvprofile / "csvprofile start".
+ */
+DECLARE_STATS_GROUP(TEXT("CurveIK"), STATGROUP_CurveIK, STATCAT_Advanced);
+
+/** Time spent searching for a curve with the correct arc-length, including sampling */
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Fit"), STAT_CurveIK_Fit, STATGROUP_CurveIK, CURVEIKSOLVER_API);
+
+/** Time spent evaluating points on the curve to fill the curve cache */
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Sampling"), STAT_CurveIK_Sampling, STATGROUP_CurveIK, CURVEIKSOLVER_API);
+
+/** Time spent testing fitted curves against colliders and refitting them around penetrations */
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Collision"), STAT_CurveIK_Collision, STATGROUP_CurveIK, CURVEIKSOLVER_API);
+
+/** Time spent placing chain links along the fitted curve */
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Placement"), STAT_CurveIK_Placement, STATGROUP_CurveIK, CURVEIKSOLVER_API);
+
+/** Time spent rotating and rolling bones to follow the placed links */
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Rotation"), STAT_CurveIK_Rotation, STATGROUP_CurveIK, CURVEIKSOLVER_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Solves"), STAT_CurveIK_Solves, STATGROUP_CurveIK, CURVEIKSOLVER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Iterations"), STAT_CurveIK_Iterations, STATGROUP_CurveIK, CURVEIKSOLVER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cache Samples"), STAT_CurveIK_CacheSamples, STATGROUP_CurveIK, CURVEIKSOLVER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Non-Converged Solves"), STAT_CurveIK_NonConverged, STATGROUP_CurveIK, CURVEIKSOLVER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Shared Cache Hits"), STAT_CurveIK_SharedCacheHits, STATGROUP_CurveIK, CURVEIKSOLVER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Shared Cache Misses"), STAT_CurveIK_SharedCacheMisses, STATGROUP_CurveIK, CURVEIKSOLVER_API);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(CURVEIKSOLVER_API, CurveIK);
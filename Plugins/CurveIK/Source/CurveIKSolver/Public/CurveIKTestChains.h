@@ -0,0 +1,32 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CurveIKCore.h"
+#include "Math/RandomStream.h"
+
+// Test helpers only, left out of shipping and test builds
+#if WITH_DEV_AUTOMATION_TESTS
+
+/** A randomized chain and a target to solve it towards, for the automation tests, benchmark and Pareto sweep */
+struct FCurveIKTestChain
+{
+	TArray<FCurveIKChainLink> Links;
+	float MaximumReach = 0.f;
+	FVector Target = FVector::ZeroVector;
+};
+
+namespace CurveIK_AnimationCore
+{
+	/**
+	 * Builds a straight chain from Root along X, with MinLinks to MaxLinks links of MinLength to MaxLength each. The
+	 * target is left at the origin.
+	 */
+	CURVEIKSOLVER_API FCurveIKTestChain MakeRandomChain(FRandomStream& Random, const FVector& Root, int32 MinLinks, int32 MaxLinks,
+	                                                    float MinLength, float MaxLength);
+
+	/** A point in a random direction from the chain's root, between MinReach and MaxReach of its reach away */
+	CURVEIKSOLVER_API FVector GetRandomTarget(FRandomStream& Random, const FCurveIKTestChain& Chain, float MinReach, float MaxReach);
+
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
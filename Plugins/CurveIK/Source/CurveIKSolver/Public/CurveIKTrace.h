@@ -0,0 +1,161 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeBool.h"
+#include "CurveIKCore.h"
+
+/**
+ * Solver inputs captured to a compact binary trace, to be replayed as a benchmark workload or a bit-exact repro.
+ *
+ * A trace is a header followed by records. Every record starts with its type and the stream it belongs to, one stream
+ * per solving node. Settings and Chain records are only written when they change, so most records are Solve records
+ * holding the root and target. The solver only reads the root position and link lengths of a chain, so these are all
+ * the inputs it needs. Colliders are not captured.
+ *
+ *   Header:   uint32 Magic, uint32 Version
+ *   Settings: uint8 Type, int32 Stream, FCurveIKTraceSettings fields in declaration order
+ *   Chain:    uint8 Type, int32 Stream, int32 NumLinks, float Lengths[NumLinks]
+ *   Solve:    uint8 Type, int32 Stream, FVector Root, FVector Target, int32 Iterations, float TipError
+ *
+ * Iterations is INDEX_NONE when the result cannot be reproduced from the trace alone, such as with colliders or the
+ * shared curve cache. Values are stored in the recording platform's byte order. Records are in order within a stream,
+ * but streams are written a chunk at a time, so records of different streams are not in the order they were solved.
+ */
+namespace CurveIKTrace
+{
+	static const uint32 Magic = 0x544B4943; // 'CIKT'
+	static const uint32 Version = 1;
+
+	enum class ERecordType : uint8
+	{
+		Settings = 1,
+		Chain = 2,
+		Solve = 3,
+	};
+}
+
+/** The solver settings of a stream */
+struct FCurveIKTraceSettings
+{
+	float ControlPointWeight = 0.f;
+	int32 MaxIterations = 0;
+	float CurveFitTolerance = 0.f;
+	int32 NumPointsOnCurve = 0;
+	float Stretch = 0.f;
+	float HandleAngle = 0.f;
+	float MaxCurveError = 0.f;
+	uint8 CurveType = 0;
+	uint8 bUseSharedCurveCache = 0;
+
+	bool operator==(const FCurveIKTraceSettings& Other) const
+	{
+		return ControlPointWeight == Other.ControlPointWeight && MaxIterations == Other.MaxIterations
+			&& CurveFitTolerance == Other.CurveFitTolerance && NumPointsOnCurve == Other.NumPointsOnCurve
+			&& Stretch == Other.Stretch && HandleAngle == Other.HandleAngle && MaxCurveError == Other.MaxCurveError
+			&& CurveType == Other.CurveType && bUseSharedCurveCache == Other.bUseSharedCurveCache;
+	}
+};
+
+/** A solving node's stream in the current trace. Copies start without a stream. */
+struct FCurveIKTraceStream
+{
+	FCurveIKTraceStream() = default;
+	FCurveIKTraceStream(const FCurveIKTraceStream&) {}
+	FCurveIKTraceStream& operator=(const FCurveIKTraceStream&) { return *this; }
+
+	uint32 Session = 0;
+	int32 Id = INDEX_NONE;
+};
+
+/**
+ * Writes solver inputs to a trace file while recording, which is started and stopped with the CurveIK.Trace.Start
+ * and CurveIK.Trace.Stop console commands. Safe to use from any thread. Each stream buffers its own records, so
+ * streams recorded from different threads do not wait on each other, and the buffers are merged into the file as they
+ * fill up and when recording stops.
+ */
+class CURVEIKSOLVER_API FCurveIKTraceWriter
+{
+public:
+	static FCurveIKTraceWriter& Get();
+
+	/** Starts recording to Filename, ending any trace in progress */
+	bool Start(const FString& Filename);
+
+	/** Ends the trace in progress and closes its file */
+	void Stop();
+
+	bool IsRecording() const { return bRecording; }
+
+	/**
+	 * Gives InOutStream an id in the trace in progress, if it does not have one yet.
+	 *
+	 * @return The stream's id, or INDEX_NONE if nothing is being recorded
+	 */
+	int32 AcquireStream(FCurveIKTraceStream& InOutStream);
+
+	/**
+	 * Records a solve of Chain towards Target, after the solve. Settings and link lengths are written if they changed.
+	 *
+	 * @param Result The solve's outcome, or null if replaying the trace cannot reproduce it
+	 */
+	void RecordSolve(int32 StreamId, const FCurveIKTraceSettings& Settings, const TArray<FCurveIKChainLink>& Chain,
+	                 const FVector& Target, const FCurveIKSolveResult* Result);
+
+private:
+	/** The settings and chain last written for a stream, and its records not yet written to the file */
+	struct FStreamState
+	{
+		FCriticalSection Lock;
+		bool bHasSettings = false;
+		FCurveIKTraceSettings Settings;
+		TArray<float> Lengths;
+		TArray<float> LengthsScratch;
+		TArray<uint8> Buffer;
+	};
+
+	/** Appends the stream's buffered records to the file. Requires the stream's lock and Lock for reading. */
+	void FlushStream(FStreamState& Stream);
+
+	void StopLocked();
+
+	/** Guards the file, the session and the list of streams. Recording a solve only reads them. */
+	FRWLock Lock;
+
+	/** Serializes streams appending their buffers to the file */
+	FCriticalSection FileLock;
+
+	FThreadSafeBool bRecording;
+	TUniquePtr<FArchive> File;
+	uint32 Session = 0;
+	TArray<TUniquePtr<FStreamState>> Streams;
+};
+
+/** What happened when a trace was replayed */
+struct FCurveIKTraceReplayStats
+{
+	/** False if the trace was truncated or is not a trace. The other fields cover the records read before the error. */
+	bool bValid = false;
+
+	int32 NumStreams = 0;
+	int32 NumSolves = 0;
+
+	/** Number of solves replayed with a recorded result, and how many of those came out different */
+	int32 NumVerified = 0;
+	int32 NumMismatched = 0;
+
+	/** Index of the first mismatched solve, or INDEX_NONE */
+	int32 FirstMismatch = INDEX_NONE;
+
+	/** Time spent solving across all repeats, excluding parsing */
+	double SolveSeconds = 0.0;
+};
+
+namespace CurveIKTrace
+{
+	/**
+	 * Decodes a trace held in memory, such as a memory mapped file, then solves every recorded solve in order
+	 * NumRepeats times. Results are compared against the recording on the first repeat.
+	 */
+	CURVEIKSOLVER_API FCurveIKTraceReplayStats Replay(const uint8* Data, int64 Size, int32 NumRepeats);
+}
@@ -3,18 +3,30 @@
 #include "CoreMinimal.h"
 #include "CurveCache.h"
 
-UENUM(BlueprintType)
-enum EIKCurveTypes
+/*
+ * The curve shapes the solver can fit. FAnimNode_CurveIK exposes these to the editor as EIKCurveTypes.
+ */
+enum class ECurveIKCurveType : uint8
 {
-	IK_QuadraticBezier UMETA(DisplayName = "Quadratic Bezier"),
-	IK_CubicBezier UMETA(DisplayName = "Cubic Bezier"),
+	QuadraticBezier,
+	CubicBezier,
 };
 
+inline const TCHAR* LexToString(ECurveIKCurveType CurveType)
+{
+	switch (CurveType)
+	{
+	case ECurveIKCurveType::QuadraticBezier: return TEXT("QuadraticBezier");
+	case ECurveIKCurveType::CubicBezier: return TEXT("CubicBezier");
+	default: return TEXT("Unknown");
+	}
+}
+
 /*
  * Abstract base class representing all the required methods for a curve to be useable in the IK system.
  * To add a new curve type, extend this class.
  */
-class IKCurve
+class CURVEIKSOLVER_API IKCurve
 {
 public:
 	float ArcLength = 0;
@@ -51,6 +63,6 @@ public:
 	 *
 	 * @param TargetArcLength The arc-length for which we want to retrieve a point on the curve.
 	 */
-	virtual FCurvePoint Approximate(float TargetArcLength) = 0;
+	virtual FCurvePoint Approximate(float TargetArcLength) const = 0;
 };
 
@@ -10,7 +10,7 @@
  *
  */
 
-class IKCurveBezier : public IKCurve
+class CURVEIKSOLVER_API IKCurveBezier : public IKCurve
 {
 public:
 	FCurveIK_CurveCache CurveCache;
@@ -33,7 +33,7 @@ public:
 	FVector Evaluate(float T) const override;
 	FVector EvaluateDerivative(float T) const override;
 	FVector EvaluateNormal(float T) const override;
-	FCurvePoint Approximate(float TargetArcLength) override;
+	FCurvePoint Approximate(float TargetArcLength) const override;
 	// End of IKCurve base class
 
 	/*
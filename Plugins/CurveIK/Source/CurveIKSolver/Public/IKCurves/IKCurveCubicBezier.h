@@ -0,0 +1,139 @@
+#pragma once
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CurveCache.h"
+#include "IKCurve.h"
+
+/**
+ * Implements a quadratic bezier curve type. Handles and points are described by the control polygon
+ * defined by points A, B, and C
+ *
+ */
+
+class CURVEIKSOLVER_API IKCurveCubicBezier : public IKCurve
+{
+public:
+	FCurveIK_CurveCache CurveCache;
+
+	IKCurveCubicBezier()
+		: A(FVector::ZeroVector)
+		, B(FVector::ZeroVector)
+		, C(FVector::ZeroVector)
+		, D(FVector::ZeroVector)
+	{
+	}
+
+	IKCurveCubicBezier(FVector const A, FVector const B, FVector const C)
+		: A(A)
+		, B(B)
+		, C(C)
+		, D(FVector::ZeroVector)
+	{
+		CurveType = ECurveIKCurveType::QuadraticBezier;
+	}
+
+	IKCurveCubicBezier(FVector const A, FVector const B, FVector const C, FVector const D)
+		: A(A)
+		, B(B)
+		, C(C)
+		, D(D)
+	{
+		CurveType = ECurveIKCurveType::CubicBezier;
+	}
+
+	// IKCurve base class
+	FVector Evaluate(float T) const override;
+	FVector EvaluateDerivative(float T) const override;
+	FVector EvaluateNormal(float T) const override;
+	FCurvePoint Approximate(float TargetArcLength) const override;
+	// End of IKCurve base class
+
+	/*
+	 * Evaluates some number of points on the curve and caches their value.
+	 * This method must be called before using IKCurveCubicBezier::Approximate
+	 */
+	void EvaluateMany(int32 NumPoints);
+
+	/*
+	 * Returns the number of evenly spaced samples needed for the polyline through them to stay within
+	 * MaxError of the curve. Derived from the second differences of the control polygon, which bound
+	 * the curve's second derivative.
+	 */
+	int32 GetNumPointsForError(float MaxError) const;
+
+	/*
+	 * Moves the curve and its cached points by a similarity transform. Arc-lengths are scaled by the
+	 * transform's scale, which must be uniform.
+	 */
+	void Transform(const FTransform& Transform);
+
+	/* Writes the curve's control points to the first 3 (quadratic) or 4 (cubic) elements of OutControlPoints */
+	void GetControlPoints(TArray<FVector, TInlineAllocator<4>>& OutControlPoints) const;
+
+	/*
+	 * Approximates the handle height for a given arc length. FindCurve starts its search from this height.
+	 */
+	static float GetHandleHeight(FVector P1, FVector P2, float HandleWeight, float ArcLength);
+
+	/*
+	 * Iteratively searches the space of possible curves that extend from P1 to P2
+	 * while varying the height until a curve with the proper arc-length is found.
+	 *
+	 * @param MaxCurveError When greater than zero, each curve is sampled finely enough to stay within this distance
+	 *                      of the true curve and NumPoints is ignored
+	 * @param OutIterations Receives the number of curves evaluated before the search stopped
+	 * @param OutNumSamples Receives the number of points evaluated across all curves
+	 * @param OutHandleHeight Receives the handle height of the returned curve, when set
+	 *
+	 * @return The Bezier curve with the closest arc-length to the target within the allowable tolerance, or null
+	 *         if MaxIterations is less than one. The caller takes ownership of the returned curve.
+	 */
+	static IKCurveCubicBezier* FindCurve(FVector P1, FVector P2, FVector HandleDir, float HandleWeight,
+	                                                         float TargetArcLength, int MaxIterations,
+	                                                         float CurveFitTolerance, int NumPoints,
+	                                                         TArray<FVector, TInlineAllocator<4>>& ControlPoints, float HandleAngle,
+	                                                         ECurveIKCurveType CurveType, float MaxCurveError,
+	                                                         int& OutIterations, int& OutNumSamples, float* OutHandleHeight = nullptr);
+
+	/*
+	 * Fits a curve starting from a predicted handle height instead of searching for one. The predicted curve is kept
+	 * if it is within CurveFitTolerance, otherwise one Newton step along ArcLengthSlope is taken. If neither curve is
+	 * within CurveFitTolerance, the height is searched for as FindCurve does. The closest curve is returned.
+	 *
+	 * @param ArcLengthSlope The rate of change of the curve's arc-length with handle height, near HandleHeight
+	 * @param MaxIterations Limits the search, when the prediction and its Newton step both miss
+	 *
+	 * @return The refined curve. The caller takes ownership of the returned curve.
+	 */
+	static IKCurveCubicBezier* RefineCurve(FVector P1, FVector P2, FVector HandleDir, float HandleWeight,
+	                                       float TargetArcLength, float HandleHeight, float ArcLengthSlope,
+	                                       int MaxIterations, float CurveFitTolerance, int NumPoints,
+	                                       TArray<FVector, TInlineAllocator<4>>& ControlPoints, float HandleAngle,
+	                                       ECurveIKCurveType CurveType, float MaxCurveError,
+	                                       int& OutIterations, int& OutNumSamples);
+
+	/*
+	 * Builds the curve from P1 to P2 with its handles HandleHeight along HandleDir, placed the same way as FindCurve
+	 * places them. The curve is not sampled. The caller takes ownership of the returned curve.
+	 */
+	static IKCurveCubicBezier* MakeCurve(FVector P1, FVector P2, FVector HandleDir, float HandleWeight, float HandleHeight,
+	                                     float HandleAngle, ECurveIKCurveType CurveType);
+
+	/* Samples the curve with NumPoints points, or as many as MaxCurveError needs when it is greater than zero. Returns the count. */
+	int32 EvaluateForFit(int32 NumPoints, float MaxCurveError);
+
+private:
+	FVector A;
+	FVector B;
+	FVector C;
+	FVector D;
+
+	ECurveIKCurveType CurveType = ECurveIKCurveType::QuadraticBezier;
+
+	/*
+	 * Combines start position, direction, and distance to produce a vector describing a handle location
+	 * in component space.
+	 */
+	static FVector GetHandleLocation(FVector HandleStart, FVector HandleDir, float HandleHeight);
+};
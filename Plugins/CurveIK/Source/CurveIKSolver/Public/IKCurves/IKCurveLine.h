@@ -4,7 +4,7 @@
 #include "CurveCache.h"
 #include "IKCurve.h"
 
-class IKCurveLine : public IKCurve
+class CURVEIKSOLVER_API IKCurveLine : public IKCurve
 {
 public:
 
@@ -21,11 +21,11 @@ public:
 	FVector Evaluate(float T) const override;
 	FVector EvaluateDerivative(float T) const override;
 	FVector EvaluateNormal(float T) const override;
-	FCurvePoint Approximate(float TargetArcLength) override;
+	FCurvePoint Approximate(float TargetArcLength) const override;
 	// End of IKCurve base class
 
 	/*
-	 * Provides a curve object described by the given parameters
+	 * Provides a curve object described by the given parameters. The caller takes ownership of the returned curve.
 	 */
 	static IKCurveLine* FindCurve(FVector P1, FVector P2, FVector HandleDir, float TargetArcLength);
 
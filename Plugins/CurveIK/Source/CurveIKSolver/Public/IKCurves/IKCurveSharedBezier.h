@@ -0,0 +1,37 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IKCurve.h"
+#include "IKCurveCubicBezier.h"
+
+/*
+ * A bezier curve owned by FCurveIKSharedCurveCache, moved into place by a similarity transform. The curve and its
+ * cached points are shared with every other solve that uses them and are never copied; points are transformed as
+ * they are read.
+ */
+class CURVEIKSOLVER_API IKCurveSharedBezier : public IKCurve
+{
+public:
+	IKCurveSharedBezier(const TSharedRef<const IKCurveCubicBezier, ESPMode::ThreadSafe>& Curve, const FTransform& Transform);
+
+	// IKCurve base class
+	FVector Evaluate(float T) const override;
+	FVector EvaluateDerivative(float T) const override;
+	FVector EvaluateNormal(float T) const override;
+	FCurvePoint Approximate(float TargetArcLength) const override;
+	// End of IKCurve base class
+
+	/* The shared curve, before it is transformed */
+	const IKCurveCubicBezier& GetCurve() const { return *Curve; }
+
+	/* Moves the shared curve into place. Its scale is uniform. */
+	const FTransform& GetTransform() const { return Transform; }
+
+	/* Writes the transformed control points to the first 3 (quadratic) or 4 (cubic) elements of OutControlPoints */
+	void GetControlPoints(TArray<FVector, TInlineAllocator<4>>& OutControlPoints) const;
+
+private:
+	TSharedRef<const IKCurveCubicBezier, ESPMode::ThreadSafe> Curve;
+	FTransform Transform;
+	float Scale;
+};
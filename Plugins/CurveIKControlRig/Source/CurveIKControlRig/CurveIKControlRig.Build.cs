@@ -0,0 +1,25 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+/*
+ * Control Rig units for the CurveIK solver, so rigs running in Control Rig can use it without FAnimNode_CurveIK.
+ */
+public class CurveIKControlRig : ModuleRules
+{
+	public CurveIKControlRig(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(
+			new string[] {
+					"Core",
+					"CoreUObject",
+					"Engine",
+					"ControlRig",
+					"CurveIK",
+					"CurveIKSolver",
+			}
+			);
+	}
+}
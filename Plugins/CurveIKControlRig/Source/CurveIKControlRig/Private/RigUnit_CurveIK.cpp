@@ -0,0 +1,113 @@
+#include "RigUnit_CurveIK.h"
+#include "Algo/Reverse.h"
+#include "Units/RigUnitContext.h"
+
+void FRigUnit_CurveIK::Execute(const FRigUnitContext& Context)
+{
+	FRigBoneHierarchy* Hierarchy = ExecuteContext.GetBones();
+	if (Hierarchy == nullptr)
+	{
+		return;
+	}
+
+	TArray<int32>& BoneIndices = WorkData.BoneIndices;
+	TArray<float>& BoneLengths = WorkData.BoneLengths;
+
+	// The chain layout only depends on the hierarchy and the bone names, so it is gathered once
+	if (Context.State == EControlRigState::Init)
+	{
+		BoneIndices.Reset();
+		BoneLengths.Reset();
+		WorkData.MaximumReach = 0.f;
+
+		const int32 RootIndex = Hierarchy->GetIndex(RootBone);
+		int32 BoneIndex = Hierarchy->GetIndex(TipBone);
+		while (BoneIndex != INDEX_NONE && BoneIndex != RootIndex)
+		{
+			BoneIndices.Add(BoneIndex);
+			BoneIndex = (*Hierarchy)[BoneIndex].ParentIndex;
+		}
+
+		if (RootIndex == INDEX_NONE || BoneIndex == INDEX_NONE)
+		{
+			UE_LOG(LogAnimation, Warning, TEXT("Curve IK: %s is not a descendant of %s"), *TipBone.ToString(), *RootBone.ToString());
+			BoneIndices.Reset();
+			return;
+		}
+
+		BoneIndices.Add(RootIndex);
+		Algo::Reverse(BoneIndices);
+
+		for (int32 ChainIndex = 0; ChainIndex < BoneIndices.Num(); ChainIndex++)
+		{
+			const float Length = ChainIndex == 0 ? 0.f : FVector::Dist(Hierarchy->GetInitialGlobalTransform(BoneIndices[ChainIndex]).GetLocation(),
+			                                                           Hierarchy->GetInitialGlobalTransform(BoneIndices[ChainIndex - 1]).GetLocation());
+			BoneLengths.Add(Length);
+			WorkData.MaximumReach += Length;
+		}
+		return;
+	}
+
+	if (Context.State != EControlRigState::Update || BoneIndices.Num() < 2)
+	{
+		return;
+	}
+
+	TArray<FTransform>& Transforms = WorkData.Transforms;
+	TArray<FCurveIKChainLink>& Chain = WorkData.Chain;
+	Transforms.Reset(BoneIndices.Num());
+	Chain.Reset(BoneIndices.Num());
+
+	// Zero length bones are not links of their own, they follow their parent link like in FAnimNode_CurveIK
+	for (int32 TransformIndex = 0; TransformIndex < BoneIndices.Num(); TransformIndex++)
+	{
+		Transforms.Add(Hierarchy->GetGlobalTransform(BoneIndices[TransformIndex]));
+		if (TransformIndex == 0 || !FMath::IsNearlyZero(BoneLengths[TransformIndex]))
+		{
+			Chain.Add(FCurveIKChainLink(Transforms[TransformIndex].GetLocation(), BoneLengths[TransformIndex], BoneIndices[TransformIndex], TransformIndex));
+		}
+		else
+		{
+			Chain.Last().ChildZeroLengthTransformIndices.Add(TransformIndex);
+		}
+	}
+
+	const FCurveIKSolveResult Result = CurveIK_AnimationCore::SolveCurveIK(
+		Chain, EffectorLocation, ControlPointWeight, WorkData.MaximumReach, MaxIterations, CurveFitTolerance, CurveDetail, Stretch,
+		nullptr, HandleAngle, ToSolverCurveType(CurveType), MaxCurveError, bUseSharedCurveCache);
+	TipError = Result.TipError;
+
+	for (int32 LinkIndex = 0; LinkIndex < Chain.Num(); LinkIndex++)
+	{
+		const FCurveIKChainLink& Link = Chain[LinkIndex];
+		const FVector OldLocation = Transforms[Link.TransformIndex].GetLocation();
+
+		// Turn each bone towards its child link and roll it to follow the curve, the same way FAnimNode_CurveIK does
+		FQuat DeltaRotation = FQuat::Identity;
+		if (LinkIndex < Chain.Num() - 1)
+		{
+			const FCurveIKChainLink& ChildLink = Chain[LinkIndex + 1];
+			const FVector OldDir = (Transforms[ChildLink.TransformIndex].GetLocation() - OldLocation).GetSafeNormal();
+			const FVector NewDir = (ChildLink.Position - Link.Position).GetSafeNormal();
+
+			FTransform& BoneTransform = Transforms[Link.TransformIndex];
+			BoneTransform.SetRotation(CurveIK_AnimationCore::OrientLinkBone(BoneTransform.GetRotation(), OldDir, NewDir,
+			                                                                Link.CurvePoint.Normal, DeltaRotation));
+		}
+		Transforms[Link.TransformIndex].SetLocation(Link.Position);
+
+		for (const int32 ChildTransformIndex : Link.ChildZeroLengthTransformIndices)
+		{
+			FTransform& ChildTransform = Transforms[ChildTransformIndex];
+			ChildTransform.SetRotation(DeltaRotation * ChildTransform.GetRotation());
+			ChildTransform.NormalizeRotation();
+			ChildTransform.SetLocation(Link.Position);
+		}
+	}
+
+	// Root to tip, so each bone is set after its parent has moved it
+	for (int32 TransformIndex = 0; TransformIndex < BoneIndices.Num(); TransformIndex++)
+	{
+		Hierarchy->SetGlobalTransform(BoneIndices[TransformIndex], Transforms[TransformIndex], bPropagateToChildren);
+	}
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CurveIKCore.h"
+#include "CurveIKTypes.h"
+#include "Units/Highlevel/RigUnit_HighlevelBase.h"
+#include "RigUnit_CurveIK.generated.h"
+
+/** Chain layout and solver state kept between executions of FRigUnit_CurveIK */
+USTRUCT()
+struct FRigUnit_CurveIK_WorkData
+{
+	GENERATED_BODY()
+
+	/** Hierarchy indices of the bones from root to tip */
+	UPROPERTY(transient)
+	TArray<int32> BoneIndices;
+
+	/** Initial pose distance from each bone to its parent. Zero for the root. */
+	UPROPERTY(transient)
+	TArray<float> BoneLengths;
+
+	UPROPERTY(transient)
+	float MaximumReach = 0.f;
+
+	/** Chain links of the non zero length bones, reused by every solve */
+	TArray<FCurveIKChainLink> Chain;
+
+	/** Global transforms of the chain bones, reused by every solve */
+	TArray<FTransform> Transforms;
+};
+
+/**
+ * Bends the bones from RootBone to TipBone along a bezier curve that ends at EffectorLocation, with
+ * CurveIK_AnimationCore::SolveCurveIK. Matches the settings and behaviour of the Curve IK anim node.
+ */
+USTRUCT(meta = (DisplayName = "Curve IK", Category = "Hierarchy", Keywords = "Curve, Bezier, Chain, IK, Tentacle, Tail"))
+struct CURVEIKCONTROLRIG_API FRigUnit_CurveIK : public FRigUnit_HighlevelBaseMutable
+{
+	GENERATED_BODY()
+
+	FRigUnit_CurveIK()
+		: EffectorLocation(FVector::ZeroVector)
+		, ControlPointWeight(0.5f)
+		, CurveType(IK_QuadraticBezier)
+		, MaxIterations(100)
+		, CurveDetail(20)
+		, MaxCurveError(0.f)
+		, CurveFitTolerance(0.01f)
+		, Stretch(0.f)
+		, HandleAngle(0.f)
+		, bUseSharedCurveCache(false)
+		, bPropagateToChildren(true)
+		, TipError(0.f)
+	{
+	}
+
+	virtual void Execute(const FRigUnitContext& Context) override;
+
+	UPROPERTY(meta = (Input, Constant, BoneName))
+	FName RootBone;
+
+	UPROPERTY(meta = (Input, Constant, BoneName))
+	FName TipBone;
+
+	/** The location that the tip extends towards, in global space */
+	UPROPERTY(meta = (Input))
+	FVector EffectorLocation;
+
+	/** Controls how close to the root or tip the control point is placed */
+	UPROPERTY(meta = (Input, ClampMin = "0", ClampMax = "1"))
+	float ControlPointWeight;
+
+	UPROPERTY(meta = (Input))
+	TEnumAsByte<EIKCurveTypes> CurveType;
+
+	UPROPERTY(meta = (Input, ClampMin = "1"))
+	int32 MaxIterations;
+
+	UPROPERTY(meta = (Input))
+	int32 CurveDetail;
+
+	UPROPERTY(meta = (Input, ClampMin = "0"))
+	float MaxCurveError;
+
+	UPROPERTY(meta = (Input))
+	float CurveFitTolerance;
+
+	UPROPERTY(meta = (Input, ClampMin = "0", ClampMax = "1"))
+	float Stretch;
+
+	UPROPERTY(meta = (Input))
+	float HandleAngle;
+
+	UPROPERTY(meta = (Input))
+	bool bUseSharedCurveCache;
+
+	/** Move the children of the chain bones along with them */
+	UPROPERTY(meta = (Input))
+	bool bPropagateToChildren;
+
+	/** Distance from the tip to the effector, or to the closest reachable point towards it */
+	UPROPERTY(meta = (Output))
+	float TipError;
+
+private:
+	UPROPERTY(transient)
+	FRigUnit_CurveIK_WorkData WorkData;
+};